@@ -0,0 +1,314 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch.h"
+
+#include <algorithm>
+
+namespace
+{
+  /**
+   * @brief The size of the input handed to each task, and the number of tasks in flight per worker
+   **/
+  std::size_t const CHUNK_BYTES = 4096;
+  std::size_t const CHUNKS_PER_WORKER = 16;
+}
+
+BatchSolver::Summary::Summary() : total(0), solved(0), unsolvable(0), aborted(0), invalid(0)
+{
+}
+
+BatchSolver::Chunk::Chunk(PuzzleReader const& reader)
+  : reader(reader), corpus(nullptr), first(0), count(0), done(false)
+{
+}
+
+BatchSolver::Chunk::Chunk(std::string const& bytes, std::size_t base)
+  : bytes(bytes), reader(this->bytes.data(), this->bytes.size(), base), corpus(nullptr), first(0),
+    count(0), done(false)
+{
+}
+
+BatchSolver::Chunk::Chunk(PackedCorpus const& corpus, std::size_t first, std::size_t count)
+  : reader(nullptr, 0), corpus(&corpus), first(first), count(count), done(false)
+{
+}
+
+BatchSolver::BatchSolver(std::size_t threads, SolveLimits const& limits,
+                         SolveLimits::clock::duration timeout)
+  : pool(threads), limits(limits), timeout(timeout), sudokus(pool.size()),
+    grids(pool.size(), Grid(0))
+{
+}
+
+std::size_t BatchSolver::threads() const
+{
+  return this->pool.size();
+}
+
+void BatchSolver::solve_one(Sudoku& sudoku, PuzzleReader& reader, std::string& line,
+                            std::string& errors, Summary& summary) const
+{
+  std::size_t start = reader.offset();
+
+  summary.total++;
+
+  if (!sudoku.read_puzzle_from_reader(reader))
+  {
+    summary.invalid++;
+    line += "invalid";
+
+    //either the reader found a problem, or the puzzle is well-formed but contradicts itself
+    std::size_t offset = reader.failed() ? reader.error_offset() : start;
+    char const* message = reader.failed() ? reader.error_message() : "the known values conflict";
+
+    errors += "offset " + std::to_string(offset) + ": " + message + "\n";
+    return;
+  }
+
+  solve_loaded(sudoku, line, summary);
+}
+
+void BatchSolver::solve_record(Sudoku& sudoku, Grid& grid, PackedCorpus const& corpus,
+                               std::size_t index, std::string& line, std::string& errors,
+                               Summary& summary) const
+{
+  summary.total++;
+
+  bool intact = corpus.get(index, grid);
+
+  if (!intact || !sudoku.read_puzzle_from_grid(grid))
+  {
+    summary.invalid++;
+    line += "invalid";
+
+    char const* message = intact ? "the known values conflict" : "a value is out of range";
+    errors += "record " + std::to_string(index) + ": " + message + "\n";
+    return;
+  }
+
+  solve_loaded(sudoku, line, summary);
+}
+
+void BatchSolver::solve_loaded(Sudoku& sudoku, std::string& line, Summary& summary) const
+{
+  SolveLimits bounds = this->limits;
+
+  //the timeout starts with the solve, and never pushes back the deadline of the batch
+  if (this->timeout != SolveLimits::clock::duration::zero())
+  {
+    bounds.deadline = std::min(bounds.deadline, SolveLimits::clock::now() + this->timeout);
+  }
+
+  switch (sudoku.solve_bitboard_style(bounds))
+  {
+    case SolveResult::SOLVED:
+    {
+      //write the solution straight into the output, which only grows once in a while
+      std::size_t length = line.size(), size = sudoku.size(Layout::COMPACT);
+      line.resize(length + size);
+      sudoku.write(&line[length], size, Layout::COMPACT);
+      summary.solved++;
+      break;
+    }
+    case SolveResult::UNSOLVABLE:
+      summary.unsolvable++;
+      line += "unsolvable";
+      break;
+    case SolveResult::ABORTED:
+      summary.aborted++;
+      line += "aborted";
+      break;
+  }
+}
+
+BatchSolver::Summary BatchSolver::solve(PuzzleReader reader, std::ostream& out,
+                                        std::ostream* errors)
+{
+  std::deque<std::unique_ptr<Chunk>> window;
+  Summary summary;
+
+  while (!reader.done())
+  {
+    std::unique_ptr<Chunk> chunk(new Chunk(reader.split(CHUNK_BYTES)));
+    this->submit(window, std::move(chunk), out, errors, summary);
+  }
+
+  this->drain(window, out, errors, summary, 0);
+  out.flush();
+  return summary;
+}
+
+BatchSolver::Summary BatchSolver::solve(std::istream& in, std::ostream& out,
+                                        std::ostream* errors)
+{
+  std::deque<std::unique_ptr<Chunk>> window;
+  Summary summary;
+  std::string pending;
+  std::size_t base = 0;
+  char block[CHUNK_BYTES];
+  bool more = true;
+
+  while (more)
+  {
+    in.read(block, sizeof(block));
+    pending.append(block, in.gcount());
+    more = bool(in);
+
+    //hand over the whole puzzles read so far, and keep the last one in case it goes on
+    std::size_t length = more ? PuzzleReader::complete(pending.data(), pending.size())
+      : pending.size();
+
+    if (length != 0)
+    {
+      std::unique_ptr<Chunk> chunk(new Chunk(pending.substr(0, length), base));
+      pending.erase(0, length);
+      base += length;
+      this->submit(window, std::move(chunk), out, errors, summary);
+    }
+  }
+
+  this->drain(window, out, errors, summary, 0);
+  out.flush();
+  return summary;
+}
+
+BatchSolver::Summary BatchSolver::solve(PackedCorpus const& corpus, std::ostream& out,
+                                        std::ostream* errors)
+{
+  std::deque<std::unique_ptr<Chunk>> window;
+  Summary summary;
+
+  //about as much work per task as a chunk of text
+  std::size_t const records = std::max<std::size_t>(1, CHUNK_BYTES / (corpus.n() * corpus.n()));
+
+  for (std::size_t first = 0; first < corpus.size(); first += records)
+  {
+    std::size_t count = std::min(records, corpus.size() - first);
+    std::unique_ptr<Chunk> chunk(new Chunk(corpus, first, count));
+    this->submit(window, std::move(chunk), out, errors, summary);
+  }
+
+  this->drain(window, out, errors, summary, 0);
+  out.flush();
+  return summary;
+}
+
+std::vector<std::string> BatchSolver::solve(std::vector<std::string> const& puzzles,
+                                            Summary& summary)
+{
+  std::size_t const CHUNK_SIZE = 32;
+  std::vector<std::string> lines(puzzles.size());
+  std::vector<Summary> summaries((puzzles.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+  //every task writes to its own lines, so there is nothing to reorder
+  for (std::size_t c = 0; c < summaries.size(); c++)
+  {
+    this->pool.submit([this, c, &puzzles, &lines, &summaries](std::size_t worker)
+    {
+      std::size_t end = std::min(puzzles.size(), (c + 1) * CHUNK_SIZE);
+      std::string errors;
+
+      for (std::size_t i = c * CHUNK_SIZE; i < end; i++)
+      {
+        PuzzleReader reader(puzzles[i].data(), puzzles[i].size());
+        solve_one(this->sudokus[worker], reader, lines[i], errors, summaries[c]);
+      }
+    });
+  }
+
+  this->pool.wait();
+  summary = Summary();
+
+  for (Summary const& part : summaries)
+  {
+    summary.total += part.total;
+    summary.solved += part.solved;
+    summary.unsolvable += part.unsolvable;
+    summary.aborted += part.aborted;
+    summary.invalid += part.invalid;
+  }
+
+  return lines;
+}
+
+void BatchSolver::submit(std::deque<std::unique_ptr<Chunk>>& window, std::unique_ptr<Chunk> chunk,
+                         std::ostream& out, std::ostream* errors, Summary& summary)
+{
+  Chunk* task = chunk.get();
+  window.push_back(std::move(chunk));
+
+  this->pool.submit([this, task](std::size_t worker)
+  {
+    while (!task->reader.done())
+    {
+      solve_one(this->sudokus[worker], task->reader, task->output, task->errors, task->summary);
+      task->output += '\n';
+    }
+
+    for (std::size_t i = task->first; i < task->first + task->count; i++)
+    {
+      solve_record(this->sudokus[worker], this->grids[worker], *task->corpus, i, task->output,
+                   task->errors, task->summary);
+      task->output += '\n';
+    }
+
+    std::lock_guard<std::mutex> guard(this->lock);
+    task->done = true;
+    this->chunk_done.notify_all();
+  });
+
+  this->drain(window, out, errors, summary, CHUNKS_PER_WORKER * this->pool.size() - 1);
+}
+
+void BatchSolver::drain(std::deque<std::unique_ptr<Chunk>>& window, std::ostream& out,
+                        std::ostream* errors, Summary& summary, std::size_t keep)
+{
+  while (!window.empty())
+  {
+    Chunk& chunk = *window.front();
+
+    {
+      std::unique_lock<std::mutex> guard(this->lock);
+
+      if (!chunk.done && window.size() <= keep)
+      {
+        return;
+      }
+
+      while (!chunk.done)
+      {
+        this->chunk_done.wait(guard);
+      }
+    }
+
+    out << chunk.output;
+
+    if (errors != nullptr)
+    {
+      *errors << chunk.errors;
+    }
+
+    summary.total += chunk.summary.total;
+    summary.solved += chunk.summary.solved;
+    summary.unsolvable += chunk.summary.unsolvable;
+    summary.aborted += chunk.summary.aborted;
+    summary.invalid += chunk.summary.invalid;
+    window.pop_front();
+  }
+}
@@ -0,0 +1,198 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "packed.h"
+#include "reader.h"
+#include "sudoku.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Solves many puzzles at once on a pool of threads, keeping the solutions in input order
+ *
+ * The puzzles are cut into chunks of a few kilobytes, and every chunk is a task for the pool (see
+ * ThreadPool), so a pathological puzzle only holds up its own chunk while the other workers steal
+ * the rest. The workers parse their chunks themselves (see PuzzleReader), each into its own Sudoku
+ * instance. Finished chunks wait in a reorder buffer until every chunk before them has been written
+ * out, so the output lines up with the input no matter which worker finishes first.
+ *
+ * Every puzzle gets one line of output: the solution in the format read by
+ * Sudoku::read_puzzle_from_line(), "unsolvable", "aborted" when the solve ran out of its limits
+ * (see SolveLimits), or "invalid" when the puzzle cannot be read or its known values conflict. For
+ * the invalid puzzles, a line with the offset of the problem in the input and a description of it
+ * can also be written to a separate stream.
+ **/
+class BatchSolver
+{
+public:
+  /**
+   * @brief How the puzzles of a batch turned out
+   **/
+  struct Summary
+  {
+    Summary();
+
+    std::size_t total, solved, unsolvable, aborted, invalid;
+  };
+
+  /**
+   * @brief Start the workers
+   *
+   * @param threads The number of workers, or 0 for one per hardware thread.
+   * @param limits When to give up on each puzzle (by default, never). A deadline applies to the
+   *        whole batch.
+   * @param timeout How long each puzzle may take, from when its solve starts, or zero for no
+   *        limit.
+   **/
+  explicit BatchSolver(std::size_t threads = 0, SolveLimits const& limits = SolveLimits(),
+                       SolveLimits::clock::duration timeout = SolveLimits::clock::duration());
+
+  /**
+   * @brief The number of workers
+   **/
+  std::size_t threads() const;
+
+  /**
+   * @brief Solve every puzzle of a buffer, such as a memory-mapped file (see MappedFile). The
+   *        workers parse their chunks straight from the buffer.
+   *
+   * @param reader A reader over the buffer.
+   * @param out The stream of solutions.
+   * @param errors Where to describe the invalid puzzles, if anywhere.
+   * @return BatchSolver::Summary The number of puzzles of each kind.
+   **/
+  Summary solve(PuzzleReader reader, std::ostream& out, std::ostream* errors = nullptr);
+  /**
+   * @brief Solve every puzzle of a stream, such as a pipe, which is read a block at a time
+   *
+   * @param in The stream of puzzles.
+   * @param out The stream of solutions.
+   * @param errors Where to describe the invalid puzzles, if anywhere.
+   * @return BatchSolver::Summary The number of puzzles of each kind.
+   **/
+  Summary solve(std::istream& in, std::ostream& out, std::ostream* errors = nullptr);
+  /**
+   * @brief Solve every record of a packed file (see PackedCorpus), which takes no parsing at all.
+   *        The invalid records are described by their index.
+   *
+   * @param corpus The records.
+   * @param out The stream of solutions.
+   * @param errors Where to describe the invalid puzzles, if anywhere.
+   * @return BatchSolver::Summary The number of puzzles of each kind.
+   **/
+  Summary solve(PackedCorpus const& corpus, std::ostream& out, std::ostream* errors = nullptr);
+  /**
+   * @brief Solve a list of puzzles, each one either a grid or a single line.
+   *
+   * @param puzzles The puzzles.
+   * @param summary Set to the number of puzzles of each kind.
+   * @return std::vector<std::string> One line per puzzle, as printed by the stream version, but
+   *         without the newlines.
+   **/
+  std::vector<std::string> solve(std::vector<std::string> const& puzzles, Summary& summary);
+
+private:
+  /**
+   * @brief A run of consecutive puzzles, which is solved by a single task
+   **/
+  struct Chunk
+  {
+    /**
+     * @brief A chunk of a buffer that outlives it
+     **/
+    Chunk(PuzzleReader const& reader);
+    /**
+     * @brief A chunk that keeps its own copy of the input
+     **/
+    Chunk(std::string const& bytes, std::size_t base);
+    /**
+     * @brief A run of records of a packed file
+     **/
+    Chunk(PackedCorpus const& corpus, std::size_t first, std::size_t count);
+
+    std::string bytes;
+    PuzzleReader reader;
+    PackedCorpus const* corpus;
+    std::size_t first, count;
+    std::string output, errors;
+    Summary summary;
+    bool done;
+  };
+
+  /**
+   * @brief Solve the next puzzle of a reader, and append its line to some output
+   **/
+  void solve_one(Sudoku& sudoku, PuzzleReader& reader, std::string& line, std::string& errors,
+                 Summary& summary) const;
+  /**
+   * @brief Solve a record of a packed file, and append its line to some output
+   **/
+  void solve_record(Sudoku& sudoku, Grid& grid, PackedCorpus const& corpus, std::size_t index,
+                    std::string& line, std::string& errors, Summary& summary) const;
+  /**
+   * @brief Solve the puzzle that was read in, and append its line to some output
+   **/
+  void solve_loaded(Sudoku& sudoku, std::string& line, Summary& summary) const;
+  /**
+   * @brief Queue a chunk on the pool, and then write out whatever is finished, waiting if too much
+   *        is in flight
+   **/
+  void submit(std::deque<std::unique_ptr<Chunk>>& window, std::unique_ptr<Chunk> chunk,
+              std::ostream& out, std::ostream* errors, Summary& summary);
+  /**
+   * @brief Write out and drop the chunks at the front of the reorder buffer, in order, until at
+   *        most a given number are left and the first one left is still being solved
+   **/
+  void drain(std::deque<std::unique_ptr<Chunk>>& window, std::ostream& out, std::ostream* errors,
+             Summary& summary, std::size_t keep);
+
+  ThreadPool pool;
+  /**
+   * @brief The limits of every solve, and how long each one may take on top of them.
+   **/
+  SolveLimits limits;
+  SolveLimits::clock::duration timeout;
+  /**
+   * @brief The puzzle state of every worker.
+   **/
+  std::vector<Sudoku> sudokus;
+  /**
+   * @brief The board every worker unpacks records into.
+   **/
+  std::vector<Grid> grids;
+
+  /**
+   * @brief Guards Chunk::done, and is signaled whenever a chunk is done.
+   **/
+  std::mutex lock;
+  std::condition_variable chunk_done;
+};
+
+#endif // BATCH_H
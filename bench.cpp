@@ -0,0 +1,504 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sudoku.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/*
+ * sudoku_bench solves a few embedded corpora of puzzles with every strategy of the Sudoku class,
+ * and prints one line of JSON per corpus and strategy, with the throughput and the latency
+ * percentiles of the solves, so that the numbers can be tracked from one release to the next.
+ */
+
+namespace
+{
+  /**
+   * @brief Generated 9*9 puzzles with 36 clues each
+   **/
+  char const* const EASY9[] =
+  {
+    ".249..3.......2...9..48...5.56.2.834..864..91.49.5....8.12....3.325.8.1.59...4.6.",
+    ".1..4...89.7.864.2..87.3.16..36..1.442.3........5..3.....93.7655...61...632.7.8..",
+    ".48.9.3..2...4..96...51..7.6.4...93.......2818.2.31.6......3..257..26.19.2187..5.",
+    "2.7.9.6.8.5981.7..4836.7.2.......8..8.6...3..3...8.162.4.9...7.7625.....93.1.4...",
+    "7..239..8582.7...9....84....1.6..924..6...85.25.84.361.45.92.....8.....397...8...",
+    "91...374....4.98.....7...16.47.5...1..816.......397.6..6..721857815.623.5........",
+    "1....47.27......53.8...36..3.4.2.9..6281.93.4....4...64.1895....9.7.64.55.6..2...",
+    "..9...78.586.......27.8...48..275.9....46......4.9.56261....2..4.3.2615.9.2.41.7.",
+    ".6...9527.95.2.6.47.8...9..4.39..76.2....63..6.....15......72.5.4...2..3..23.5496",
+    ".6....5.38...496.1..5.639877..312.59..........5.6.8.7.64.1....8.7.98.2..528.....4",
+    ".5.8473....13.2..8..3...2...2567.98...94.31.2..6..9.73...9.5..151....6..6....8.25",
+    ".....53.195.2.347.341..86.2....2.8...2..7....6873.1...71....9...68...513..9.8..24",
+    ".9..3...7.31..7..5647.5...8...4.27.....17.536.....31.27....58.13.97.8..458...4.7.",
+    ".8.356.12......38...29.457656..9....37...28.9..854...1..3...6.57...651..6..4...9.",
+    ".4.813...853...912..659....6...8.129.2........89.2..5.4.563.27...795.3.6....4.5..",
+    ".8..9....9.162...32.5.478..147..9.52.9..5...8.5.1..9.483..1..9....98...1.194..2..",
+    "....1..8.8.52.6.1316..3879.25674...143..8...7.8...39...........6..8.....57.19.362",
+    "6.34..8...27.....6..4..75.3.3..8...4.9.56...8.68.1.39..169..7..2.51...8.3.9.752..",
+    "..2.3.168.642.857...5.7.243..8.6...5.1.3.768.....8.92.5......9..97..5...42.7...5.",
+    ".6.1.2..7..4...6...91....23137..42.66.27..81..8.......328671.5.4..3.9....7..45.3.",
+    "..5..69..67..48.1.4..1..73..26495.8.53..8...9..12..5748..5.4......83...73.9.....1",
+    "3.52.697...17.9..8.9.1.84.....68.73.....9.6144..37.5.2...82..5....96..43..8..3...",
+    "2..5.3..7.6528..93...69.2.....3.965.9..864312...1.....4.1....36..3...8.9.26.35...",
+    "..8549.6.....3....6..128..72613...7.3.928.6.55.....1..832...7.6..7.9..8.49...2.3.",
+    "42..53..9..32795.4.5964...7..4.86.5..9.127.4.6.....9.2...41........9..61....683..",
+    ".5..7...31.84...7.27....8....9.35.2.5.769..4....184...4..3..5...3.54.98.92.8.7.36",
+    "6...7..3..1.2436.9..26.5.7.3...8.1...2...7.4.1864.2.9.9683..2..4..72..6...3..8...",
+    "..8231...52.7.8.4...7....28.5.8.42..1.6592...9..67.....3.15..7..71.8...56...2.81.",
+    "96.1....5.38...6.7.5......96..2.5.48795..1.....49....1.496..783...53....3.67.815.",
+    "...3.7...8914..7.....8.9..2.8..45.63..32.84..2.....9..15678.3.....9.1..8.78.3261.",
+    "58....1..6.38...2..4.....581..49..35..9...74.25...68..32.7.5.89..86.15.37..9..4..",
+    "69..57.8...5.28.73.2......1..1...3654..56.....86...42......2...7...45932264..3.57",
+    "..2..69..8.9...236..4..98..7.58..621..176..58.3.5.27.4.....1..2..3.2.1.....947..3",
+    ".9.53.2..5...96..4367....51...6.....274....6363.278.4..8.9...37.2.4.....9.6.8.1.5",
+    ".7...2.....439.76..5....82.26.5.34.83.....2..18.42..39.3..469..79.18.3...16.....2",
+    "5.......32..7..15..97..5..674.6.3.1.6..28.74.1.9.7.6.2.21.6...89..148.2....9.2...",
+    "38...256..7.8..4.......6839.15......296..3.488......7.53..29.8...7.8...396835.2..",
+    ".124...6.8.76.5.29.9..28.139...6...1....92..54.35.19..1.9.4.6.72......3...6.5..9.",
+    "65......7...72..68.29....5.28..........2..3.4..41.982.9453.26.13179.6..28...14...",
+    ".5..32...37..4..1....1.53..5........28.31.79.91..5.2.6.4...1..37...6315.13.59..72",
+    "8....4.9.549...3.2.21.9.....5492.6......8.2.318..539.74.....8.52...4.7..7.5839...",
+    "..1....97....475..53...9...6..4....9.7...543194..7...8.9....1.5...814963..6953.42",
+    "..6...593..8..5..2...6.34.83.4.1.....1....8..56..3.21.....8.329.9...674.17.34968.",
+    "4...56.9..718...6.65.9.7.4851..9.2848.65.......9...6...6....81..8.4..9.3.95...42.",
+    "9.3.4.6172...3...9..4179..2.....1.7..9...2.8.....5.26481......63....4791.29..6.58",
+    ".2....6...5.8..3174..96.825..5.9.2.6...2.87.......5.38.....946..64.1.583.3..8.9.2",
+    ".5.46.....172...393.....52...3..4....2.3798..1..6.8..428.1..9..5.984...37...5.648",
+    ".468...978.5...4.12.149.38..5.....3...9.3.15.4.856..7278.....49...2...1.9..6....3",
+    "182.....5...9.........8..2..3.8246..7.81.35..64..9728....3....23.5278.9..94.157..",
+    ".7.6.3491..3..856...6.9...3....321.7.......3..3.576248..926...5.4..8.92.6..15....",
+    ".48.1..79.3...7.65....3.....615....8.5.74.6...73.61......174836..4..6....1689.4.7",
+    ".4................716.8..2.3...25.46.7....1..25.6.4.8946781..9553.49.8.7..975..6.",
+    ".67458...3....1458.........9....5.71.127...49..8....25.735.9164.9.2.75.3.5..3....",
+    "4.385.....2.....8...52673.16..3..85.5.97....2.4.52..76..6.3.72.9..1.2...28.67....",
+    "5.3..8....6...25.....5.41...87...26..9.1.3.4..21.673.9....8..131..396....3..41625",
+    "1..27.95..3.8.614.54...3..2.7.6153......2..1...6..87.5.8..6...165.73..8..23...6..",
+    ".5..8....6.9.3.8.5......36.1.685..7...5.....88937.4.169....865.4.8......56129..87",
+    "847.6.9..3..8..1...6..27........85...582...7..9.5..318..415.2.3.13..2..62.6..94.1",
+    "9.5..81.6...1.27.5.7......8..35.791.85...9.67.19.23....8.93..7.6...51..9..1...65.",
+    ".2...47....4.79.131..235.46.9..1.475247.58..16....382...13..5.4.5.........2...6..",
+    "84..9.3622....8..4..54.287.1....5.....2.417..37..6.2..56.1..4....32.65.7...9.46..",
+    ".32..9.4..75......1.4.3.2..31..6...7.9.78..15...314.8.5...971..7..1468.....85.79.",
+    "6.43..87.71..5.3...35..691....2.1.56.7.....2...6....9346.1275.....6.8.4...7.956..",
+    ".7.24.83.2..65.7....98..5......3.247.....6..37...9.1.83.4.216.5.21..54...5.964...",
+    "368....2.4.7.2..3.......4.18...74.6.7.69......43.6.7.9.74.98.1.2.1.5.69..85.13...",
+    "8.2......95..3.6..4....72.9.24...9..3...648126..2.9..51..79.5..765..31..2..6.53..",
+    "......85.2..3.89..35.9461..1..........75.46.1.83....9.54..9.7188.9.1.5.2..6.8..39",
+    ".1.3.........46.81..321..9..2....8...651..472..468.159..7.2..1828.4..93...1..37..",
+    "9........68..9.3.11.2.638.5.643.....7.81..4......8..29..9846.578.5.....44...31.82",
+    ".62.4..15.3......251...9....769.8.4..8..7.2.6...5623.8...7541.9..82..4..451....2.",
+    ".1..62..9..9.8..73...97.1..1.2.4...5....2.78..65...3.4..169..37896.....23...51.98",
+    "8..391...73...48......87943..78.93....1..6...6...2...996..3.47.57.9..1..4..76..98",
+    "4.5.6..7.9..2.58...7.1.9.5..9.7..3..3.849.76.1.735.....8....2....2..45..5.962..17",
+    "1..86.74998...712......9.3.3...46..1..5...2.6..7..1.5.532........972.41..4..9856.",
+    "51.784..6...6.1.8.6..5.3..1...3..8.22..4..7537......1..961..3.4.2....197..1.42..8",
+    "51.6.9..797.3....44....7..3...59.7.8.97..8.2..8.7..9.6...286.79..29753.1.5.......",
+    "..12.7..34.6.9.18..3.8..2.585.....3...962....76.35..1...593.6...9....5.1.7.14.3.9",
+    "7...894..2.83.5.17.3917...81..63..8.9...2.37.....9...5...96.15..9...8..3..4.5.89.",
+    ".5...97.4789.3.26..3..1..98..237.48.17....3598..9..1....8........7.94.15..5...97.",
+    "87139.....2.5.13..9....871..9..34..1.1.2..54.2...15.3.15762...44..85..2.......6..",
+    "2..97.......635.4..3.1......86.9.4..3.4821..9...46..318.935..1.46.2....55..7...26",
+    "8.951.6......9.18.61....53.76...9..24.....7..1.542..6837....24...46..9759..2..8..",
+    "3.61.2..4..2...6...7...9.25......54242..8..69....9.7..2148.69.3..59...8....523.17",
+    "4.57.8.92....96.....34.2...61..837.987.5..2.1...........78.1.23246..9.1838....9..",
+    "21...........9..5.4.5.8.17....8.3.1787.........471.9.6..2.38....876.4.9553.9718.4",
+    "...6385...345.97..5.1.2....1.6.4..3.2..9.3.7......185.31.48769..98......65.1..3..",
+    ".71.32.6...8.79...6.981.7..2.6.4.....9.2....1..47.5.26...95.613.5...82.7...12.4..",
+    "4.31..7591.83...2...95.4..3..146..9.....5...453.91...891..3...7.8..4.9...4.6.73..",
+    ".9...3..4.1..95....4.6..739.7.8.6.4.3.5.4.8...2.37...5.3.58.9.7....6.5.31..932.6.",
+    "......2...3.1256.......695...649..1.8.5.1.7699..5.7..43.8.5.1.215.....966..93..8.",
+    "526......8..6...799712.4..5169573.......6...7.5.4......93..67..4.5..79.6.8..5.14.",
+    "2.9..1.6..532.6.98..6..34............2...91..61.72.943.3..65...58.49.6319.....2.4",
+    "9.1345..2.5..61793...87.....65.2...9....3.45.349..8..6.8...29.5..25..3.8......1.4",
+    "67....92..9...26.......657.85..43.6.421.5739...7.....5..659.13.....24..62.....849",
+    "9.3.524....79.65..2.514..6..9..7...11...843..358.19.......981.......3...739.2..58",
+    "...2.5....5..9.273.2.48..1.8.95..7..1...69..464....18...16..59..9731...6.6.957...",
+    "..15.37.82.......3..58...2653..72..487..65....24..86.791..84..5.......6146....8.9",
+    ".9.2....74...95..63.1786...75...24..8...17.2.61..54...1..5.9...2.34.895..7....3.8",
+    "5.4..3...387.5...6.6..8...31.29.6.7......5.3.8.....9.24.86.73..6..4...8.2..518694",
+    "....5..3..836.1..55..3..2....453.1.783.71.542.51....9.6....43.8..2..36..3..96..2."
+  };
+
+  /**
+   * @brief Well-known hard 9*9 puzzles, starting with Arto Inkala's (see the README)
+   **/
+  char const* const HARD9[] =
+  {
+    "8..........36......7..9.2...5...7.......457.....1...3...1....68..85...1..9....4..",
+    "1....7.9..3..2...8..96..5....53..9...1..8...26....4...3......1..4......7..7...3..",
+    ".......39.....1..5..3.5.8....8.9...6.7...2...1..4.......9.8..5..2....6..4..7.....",
+    "1.......2.9.4...5...6...7...5.9.3.......7.......85..4.7.....6...3...9.8...2.....1",
+    ".......12........3..23..4....18....5.6..7.8.......9.....85.....9...4.5..47...6...",
+    ".......1.4.........2...........5.4.7..8...3....1.9....3..4..2...5.1........8.6..."
+  };
+
+  /**
+   * @brief Generated minimal 4*4 puzzles, small enough to solve by brute force
+   **/
+  char const* const SMALL4[] =
+  {
+    ".3..2.....2.4..3",
+    "..4.1......2.3..",
+    ".42....1.1..2...",
+    "..2......1.23.1.",
+    "...31...4......2",
+    "...4....4..2.3..",
+    ".12.....12...3..",
+    ".3..1.....13..4.",
+    "...4..1.4.3....1",
+    "..1.2.....3.1...",
+    "..3.1.....4.2...",
+    ".....3.41.2.....",
+    "2......1...24...",
+    ".3.4.......2.4.3",
+    "..3..1...2....2.",
+    "1.2.....2..4.1..",
+    "3.4...2.....4.3.",
+    ".....42..3....1.",
+    "....1..3....2.4.",
+    "2..4..2..3..1...",
+    "41.......2....1.",
+    "1.2...3.....2.1.",
+    "....31.....42.1.",
+    "1...3.2...4.....",
+    "..4..2......14..",
+    "1.....3..2.....4",
+    "..4.4.....3.1...",
+    "2......1..3....4",
+    "3....2...3.1..4.",
+    "42..........3.1.",
+    "......1.4....2.3",
+    "...44..3.....2..",
+    "3........43...1.",
+    ".12.....321.....",
+    "2.14........1.2.",
+    ".....3.14..3.2..",
+    "...23...1..4....",
+    "1.....2.4.....1.",
+    "3.....1...21....",
+    "..4.2..3.1......",
+    "...3..4..4..3.2.",
+    "..3....12....42.",
+    ".....1..4..3...4",
+    "....1.4......3.4",
+    "2..1......34....",
+    "43........2..4..",
+    "....2.4.4....1..",
+    ".2.3.....3..4...",
+    "..1......13.4...",
+    "....1....24....3"
+  };
+
+  /**
+   * @brief Generated minimal 16*16 puzzles
+   **/
+  char const* const SIXTEEN[] =
+  {
+    "..E........F5..AA6.....15.E...2...3......4.D1F.8FC2.56A...3..BD4"
+    "B.9.3.....GA.....A......E..7..35.26.7E..F8C9.G.......C.G...6B..."
+    "3.....69BF....E.6..71...D...A.83.1.D8..E......G.....B7.F.1......"
+    "..BE6...4A.8..1F...GD4.7...2..CE......1.G5F....D8.D2........63..",
+    ".63..2BC....D.7EC9D..F....41..2..........E.B..A...4E....7...1..."
+    "....7..E5...C.8A.G..F58.9...21E....6.D2...B.5....8....A3DG.C...."
+    "G..........435..5..2..CB...DE...AB...7....2....F.1...A3..695G.C."
+    ".A.8..D.6........F.3.1..GC......4..1AG...5E....B....6C..B....G..",
+    "3....4F.C..DB......G6.3C.A.5......EAG.B.16....242C....9.....A..8"
+    "..A98..5...E.......841..7...3.C5...3..A..1...E.9.E.1..2...93.F7."
+    "84.....3B.G..D....B..2D.9..F..A....7.E6...4...5.F..27G.....8.4E."
+    "..G.5........2F...2F.64.E.5A.1.D.D7.B.....2..5.E.........D1C..B6",
+    ".D.....B.CE29..3...76.E..3....2541..23.....7.D.C3....51...4DB.E."
+    "...2.B....16..A.A8..F...5..E..9.BC....62.DG.3..76..G3.C...8....."
+    "5..3G9F.4......1CF....7.1.2...5.1..6.....G..2.F....AD6...B..G..."
+    "..1......76....88.6...B5.....C1.....E13.B..C5A..7.B....D.....9.G",
+    "C..EG.7..51.39.....G85C...4F.....D.......2.......FBA9.4.C.38..D."
+    ".43..9..ACG....7...C...B.1D2F...9.A..C....57..2....2.F..36...CA."
+    ".G5.78.......D9.D...B6...E21....E.7.......B....2..F...G....9.7.1"
+    ".2..C....3.DB....A..F4.G....6.1.B.4..28.E.7.A.3.5...D.3.B.C..27.",
+    "C.6.9.....1F.3...FA...G.E....76D...4....6C........E.7.....D..9.5"
+    "...C..7249..B.D....2A34FD.B.1.....DE.....8.....F.1.A6......3..42"
+    ".5....8.9..1........46C..B8..F..E8..3.5..2..GA.71.3..2EA..4....."
+    "...7....5....B..4B1...D.G.F.AE8.....C4.G..6...7...89F......75.G1",
+    "..91G8.3.4.6..7....76...3........B..2A7.1.E8......4.FDC..5...38."
+    "1.A...B..........62D4..FC..7..E.EF.B13A..64..G.7G..4.E...B.21..3"
+    "...5.1264....9C.4..GC..871.5D...891...D56G..7...D..2E........5.B"
+    "...C......6D5.........F........A7G.93..A....42...1..8C42.E3....G",
+    ".EA.3....56...2G..G3.6AB..D2..F.8.....25B...E.A9...D.....79...53"
+    ".C9..17..2..F.4....E2.C.D...A...7B4.....8..C...5.315..9....ACE.."
+    ".5...91C......7....2..63..7G1..4G.8.A.5.......3..1..7...9.3....."
+    "...BD..6.4..59.A.9.F...2...D.81.E..1BG..5..6.7.F4........82....E",
+    ".....E.7.CD.632....FD..GB..2..4AB..E4.C51..3.97.....1.....A....."
+    ".F7...B......1....9C...63FB......1E3.8....47.B9G8...G..19....6.."
+    "F....3.A....E.D.4C8..51..A..3.....A......92.4....D1....F6.8G...C"
+    "C..B2..D....7E8.A..6E9F....D52..D.2.....E79.F.......3....6F..CA.",
+    "6..B...7..3.4E9.5D.G.9..1..2.B..3....E....G.F..2.8.4FG..9..B...."
+    "...2D.8.C.....6..3.6...2..5G.7C..1...B.F..8.A.GD.G8E..C.AD..53.."
+    ".E.3A4.D.8....B7.5...1.........9A..D823..G491.5.C.B......6...A8."
+    ".B.F9.G16..A7...76.5.C......8.......2...8....91.2.E...F..4.D..A5",
+    "7.E...1......2.5.D.G...F9.7..EA....265.....D.4.G.6...D..G..4..F."
+    "..7.....1D..5.C.5....7....6...BED9F4B.E6.A...3G....B.2A1.4..7..."
+    "........F3...D8...4F98B....2C..A...D..G4.E5.....2..3....A8..E..6"
+    "4..1......B....D.8...G92..36AF..3.G54..7...18.......C.3.52G...E.",
+    "...E....2.3...F...5.C.G.F.D4.2..2....7.6..1.AE..76..2.8..C.9D31."
+    "G8..EA..7F2..B...3...1..4.....E9...6...7...A..4.5.DAB.....8.6C.."
+    "CD.F.E1.G.75...A...3..6C.4.2.G..........6..C3.9..B.1G.2...9.87.C"
+    "..G9...58..3..2............BG..6...24...C.GDB.A.A..87...........",
+    "..D........A..7G..E6.5...C.2A....98..E.D.....F4.F7A.....B..8.9.."
+    "..........4....72.5.1.DBF8.....4C.619..F..G.32......8..E..3..G.."
+    ".C.9D.7......E35.......2D.9.B..CB.1....5.3....6..5.2.36..4.G7.1."
+    ".G.5..C..78..D2...43AD..C...6..8......B....3.7E.D8.7..41......C3",
+    "....D2B..1.........2.....B9.8.DCCD.6...A...EG.25...5.1........6."
+    ".5.A1......9..C.......645.FA.E326...C7.E18...BA......G.FBC..1..."
+    "2..7......8.....4.......9F....E8B.132.E8...CDF.65.9...7....4...."
+    ".6A.....G......7..E.8...7..2..1.....E4..C..6.3.AF2...51..3D.9G..",
+    "2.7...8E.59.1...561...B.F.......4....7...8..G.6....8.6G5.D.B...."
+    ".F...B.G2.4.A6.719.GF.5.A...4...6....9.....EB..2..EB......3...9."
+    "7...5.E......A83.5.DBA...6C8E......9.8..DG........81...6.....5.."
+    "....6...C.823.GEFE.6..C81..7.D......D......G.14.A.C4...13...F7..",
+    ".E.C8.....7...5.......1.A..5.9426..A.E.....C..F.D...4.9....1E.B8"
+    ".6.........A...1..A.....2DG...7..DB..F.3.....E..9.3.642B1.....A."
+    "B7165G......D..E....D672.1B........E..31F.6....9C.......7.4..F.."
+    "...D...5.6.BF.E73...A....49..2..A97...E...D...1C1.....D..7...485",
+    ".A.7.9.....4.F2...G.......5...6.8.4......6.9G7CDC.6B.48A.F.....3"
+    "D63.285....C....B.E.....83..........7..B........5..2...1.GD.7..."
+    "3E7.4.......F...........1.C..A.5...G...D.5.B2.E..C15..2.D436...."
+    "..8.C3.2B.G.65......A.G.6..5.....9..E...4.8.32..7...FB.53E...G.9",
+    "..6....3.27.4.G......1GE......7A..1..6B.CD.A..E.G...5D...1.B3..."
+    "6..9.A.D..4.7351...C3....6F.....3.8..4.B..A7E...F.E..9..B.2.6D.."
+    "..A8.2F....D...CD9.......8..1..E.C....714G....F..1.6...C7.9.B..."
+    "5....C.A6.B9.E1.................24....59A...G....B3..8..27E5.A.6",
+    "72A..C.....3.8..6C..78D.1...AG.BB....F.G.....4.......9...C.D...."
+    "...D..5F...B3....8.5G4..F....9..3...B67.E4.C..F.1..7...8G......."
+    "2....7.3.B.E...........9..A56.3...D....E..67C.G8...FA.8.C.D2E..5"
+    "D.4G.B...3..876..62.3.C.5.9.FD...F7..D..2..1..5....1........BC.2",
+    "E.78.6C9......G...9.....F7.E..8A..C3....2.45F..6G.4.2F..8....7.."
+    "8..1DG...4...E...62E.4...CB.A.....FG.2....51.8.....AC..67F..D..."
+    "...7.5..4..F..1.BC..8E..GD.3.9......3....2...A6.....G..C..A97..4"
+    "1...67..5.2A.F4....9.341...GE.28...C....D.......FGD2...A......B."
+  };
+
+  /**
+   * @brief Generated sparse 25*25 puzzles
+   **/
+  char const* const TWENTYFIVE[] =
+  {
+    "...F4KA.....7....M....J.I...8...GLIPNM..BJ..C...DKM.6B9...4FDJK.OHP..G...AEIJG.."
+    "..3...1L..8E.ANCP..41PA.....9.F....7.....G.L..IDJ.24..H.6.8.....1....N...PA..K.."
+    "OI...JF....E..C.....L.P391.5..E.G.6.K8....F4..G.JD.P.KL52C..37.1H......E.B.....N"
+    "...L84F...G..73P.A...9.L...I..N.......6....M4.7C..A..9.8.F.BN.K9..I2.3H...M..1.."
+    "6...L.C.E..F56O..N...G.3MJAI..L8.....E...F2BP.5..H.D.CG.3...8.6DKA2E....P..9C.G."
+    "..O.......85F.K.L.4.7.....15.7....JBO.6.M..E.I8NF.....DE...C...I4..B.9..2.3..L.."
+    ".1B..3.H..G.7K2.6..A.H9D..5......3EP.8.FA...74O.5..39.LK.B..1.E2....6FK..I.J...."
+    "5.9M.6DHG...E..6.3...B..G.CO..K.....4..M.M...D..P8.GI.69.5NB.1K..",
+    "27KJ..5H..E...M...P...9....CH..KI.B.....8.J.E...7.9AO...J8L....BI..7...M.DKLGP.."
+    ".C..17...6I.9.A..4B.M.B...P....H.A.1....38I2JO.A8J.DM1...7..BHE.L..CKN...2KJ.NIE"
+    "...MP.D..5.3.9..I.9..A..GL....2..M.HD.F54E...5.......8......7.MJ..C.D1.....IKF.J"
+    "9O.68E...4J.3LD...EKB18.2..G.P5...6...K2H.A..GOP.L3.6D..4.M.AB.IG..6.2.7..KM...."
+    "JEH..N....GOL9D.4..3...B.1K.P.....9..1C....6HK.5....2.......7.GB.....D5.A.MF.J.."
+    "..5.61.2.4H9.O7..KJ..L.N...41......C2...F..IND5.E9C9H.A..E.O3..5.4..2...6.I8..G."
+    "....H...1.E.....CO.7.LN.MB.4HF6..D...3..CP.A.1..OC...M...A.9.KBL6...4.B3.....JD6"
+    "P...N7A..F.O..1K..5E...A3FI.4....C2......2.....9...B3.OD5..4..FIM",
+    "F....15..E.I.C6DMH3GJ...KDL5N....F.MKP..8E...1....1..9G...8.N..B...7KC...F.CH2.I"
+    "K..G.E....F..6.BP.976..8M2B.3C.D.1..N...5.IAG.1.....A..2.C3.N.....B...O6......K."
+    "H7.F1...LED.JN2.3C..N.JM.5GE..I7.B2..P.4L..J.....3...D4.P1A.756G.......6D.BOJMLP"
+    "..G..A..I3..PK7.E.H...4..J........9.4..DL9.J8.1.5..2....OEC..CHO.AF6.MGL.7.....D"
+    ".2....A...I.N.1.PKH.BFO....73..5.284......6EM.A3.9PD.HF..B..M8..I.A..7G.J..3...D"
+    "......G.2..E..LK1A8NI..5.4GJ.......1C....HE.IN.MO.M.3E...5.L..J.I..CP.G4A1.K.N.."
+    "7....4H5..M.2.....J...M64..9LF.B...H.N..2..DIA..HFJ.C....D...69..K..E12.GI.P.HN5"
+    "..F....84M..B.LP.OL3..E.D.....C...JH.N..J...5....OL3.6N..IEBF.4.P",
+    "P..B...D...GE.7.A6...81.H.6.C.7.5AI...H1B3F.LK..D4F..9..M.84J..N....DKL7E3C.I.LG"
+    "..P...5..9...7...6.O..D8.2BF.3C.4...E.H.A....I.......G...D43C..2.H...6J..52.7..."
+    ".CB9..6..P...LD....6B.A.5GF.I.8.7....O.P..4F..2K.L5.OJ.....37.B91DGLOBF...6K...."
+    "...9.E.35.8..G.E.B..NO...M.P..3.H2LE3.....O.72.J.......IPN4..........K..C1.92L.H"
+    ".6......JN6L25G.....K7.BC.F...6A5..P......MK8.O....BD.E.5P.8DI4M.....F3L.A.O.J7K"
+    ".O6.KCN...3...4F.J.D.5......IH9O..P.21.J..K5B..4...F...A.8.JI...M7....P.....2..9"
+    "..7..AD.5..8.4EF...3.4I..LC..OM.72P.F..GN...8L...CK6MB.E8.....5P.D.9...MH...FIN8"
+    "...6KE.A.....BG.EO..4....HB.3..I.M..A2.F..G.P...D.9...CH.B1.M...."
+  };
+
+  /**
+   * @brief A set of puzzles, all of the same size, in the single line format
+   **/
+  struct Corpus
+  {
+    char const* name;
+    char const* const* puzzles;
+    std::size_t count;
+    /**
+     * @brief Whether the puzzles are small enough to be solved by brute force.
+     **/
+    bool bruteforce;
+  };
+
+  Corpus const corpora[] =
+  {
+    { "easy9", EASY9, sizeof(EASY9) / sizeof(EASY9[0]), false },
+    { "hard9", HARD9, sizeof(HARD9) / sizeof(HARD9[0]), false },
+    { "small4", SMALL4, sizeof(SMALL4) / sizeof(SMALL4[0]), true },
+    { "sixteen", SIXTEEN, sizeof(SIXTEEN) / sizeof(SIXTEEN[0]), false },
+    { "twentyfive", TWENTYFIVE, sizeof(TWENTYFIVE) / sizeof(TWENTYFIVE[0]), false }
+  };
+
+  /**
+   * @brief A way of solving a puzzle
+   **/
+  struct Strategy
+  {
+    char const* name;
+    std::function<void(Sudoku&, std::size_t threads)> solve;
+  };
+
+  std::vector<Strategy> strategies()
+  {
+    std::vector<Strategy> all;
+    all.push_back({ "colorability", [](Sudoku& s, std::size_t) { s.solve_colorability_style(); } });
+    all.push_back({ "dsatur", [](Sudoku& s, std::size_t) { s.solve_dsatur_style(); } });
+    all.push_back({ "bruteforce", [](Sudoku& s, std::size_t) { s.solve_bruteforce_style(); } });
+    all.push_back({ "dlx", [](Sudoku& s, std::size_t) { s.solve_dlx(); } });
+    all.push_back({ "bitboard", [](Sudoku& s, std::size_t) { s.solve_bitboard_style(); } });
+    all.push_back({ "parallel", [](Sudoku& s, std::size_t t) { s.solve_parallel_style(t); } });
+    //not a solver, but the uniqueness check that every published puzzle goes through
+    all.push_back({ "unique", [](Sudoku& s, std::size_t) { s.count_solutions(2); } });
+    return all;
+  }
+
+  /**
+   * @brief The latency below which a given fraction of the solves finished (nearest rank)
+   **/
+  double percentile(std::vector<double> const& sorted, double fraction)
+  {
+    std::size_t rank = std::size_t(std::ceil(fraction * sorted.size()));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+  }
+
+  /**
+   * @brief Solve every puzzle of a corpus over and over for at least some time, and print a line
+   *        of JSON about it
+   **/
+  void run(Corpus const& corpus, Strategy const& strategy, double min_time, std::size_t threads)
+  {
+    typedef std::chrono::steady_clock clock;
+
+    Sudoku sudoku;
+    std::vector<double> latencies;
+    std::size_t solved = 0;
+    double total = 0;
+
+    while (total < min_time || latencies.empty())
+    {
+      for (std::size_t i = 0; i < corpus.count; i++)
+      {
+        //only the solve is timed, not the parsing
+        sudoku.read_puzzle_from_line(corpus.puzzles[i]);
+
+        clock::time_point start = clock::now();
+        strategy.solve(sudoku, threads);
+        std::chrono::duration<double> elapsed = clock::now() - start;
+
+        if (strategy.name == std::string("unique") || sudoku.solved())
+        {
+          solved++;
+        }
+
+        latencies.push_back(elapsed.count());
+        total += elapsed.count();
+      }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+
+    std::cout << "{\"corpus\":\"" << corpus.name << "\",\"strategy\":\"" << strategy.name
+              << "\",\"threads\":" << ((strategy.name == std::string("parallel")) ? threads : 1)
+              << ",\"puzzles\":" << corpus.count << ",\"runs\":" << latencies.size()
+              << ",\"solved\":" << solved << ",\"seconds\":" << total
+              << ",\"puzzles_per_second\":" << latencies.size() / total
+              << ",\"p50_us\":" << percentile(latencies, 0.5) * 1e6
+              << ",\"p99_us\":" << percentile(latencies, 0.99) * 1e6
+              << ",\"max_us\":" << latencies.back() * 1e6 << "}" << std::endl;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  double min_time = 0.5;
+  std::size_t threads = ThreadPool::default_threads();
+  std::string only_corpus, only_strategy;
+  bool usage = false;
+
+  for (int i = 1; i < argc && !usage; i++)
+  {
+    if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+    {
+      min_time = std::atof(argv[++i]);
+    }
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+    {
+      threads = std::strtoul(argv[++i], nullptr, 10);
+    }
+    else if (std::strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+    {
+      only_corpus = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--strategy") == 0 && i + 1 < argc)
+    {
+      only_strategy = argv[++i];
+    }
+    else
+    {
+      usage = true;
+    }
+  }
+
+  if (usage)
+  {
+    std::cerr << "usage: " << argv[0] << " [--min-time SECONDS] [--threads N] [--corpus NAME]"
+              << " [--strategy NAME]" << std::endl;
+    return 2;
+  }
+
+  for (Corpus const& corpus : corpora)
+  {
+    for (Strategy const& strategy : strategies())
+    {
+      if ((!only_corpus.empty() && only_corpus != corpus.name) ||
+          (!only_strategy.empty() && only_strategy != strategy.name))
+      {
+        continue;
+      }
+
+      //brute force only finishes on the smallest boards
+      if (strategy.name == std::string("bruteforce") && !corpus.bruteforce)
+      {
+        continue;
+      }
+
+      run(corpus, strategy, min_time, threads);
+    }
+  }
+
+  return 0;
+}
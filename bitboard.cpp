@@ -0,0 +1,528 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bitboard.h"
+
+#include <algorithm>
+
+namespace
+{
+  /**
+   * @brief One row of a band, and the three rows stacked (so 0x7 * STACK is the first block)
+   **/
+  std::uint32_t const ROW = 0x1FF;
+  std::uint32_t const STACK = 0x40201;
+  std::uint32_t const BAND = 0x7FFFFFF;
+
+  /**
+   * @brief The cells of the board, and the peers of every cell
+   **/
+  struct Tables
+  {
+    Cells81 all;
+    Cells81 peers[81];
+
+    Tables() : all(Cells81::bands(BAND))
+    {
+      for (std::size_t cell = 0; cell < 81; cell++)
+      {
+        std::size_t y = cell / 9, x = cell % 9, band = y / 3;
+        std::uint32_t row = ROW << ((y % 3) * 9);
+        std::uint32_t block = (0x7 * STACK) << ((x / 3) * 3);
+        std::uint32_t column = STACK << x;
+        std::uint32_t lanes[3] = {column, column, column};
+
+        lanes[band] |= row | block;
+        this->peers[cell] = Cells81(lanes[0], lanes[1], lanes[2]).minus(Cells81::single(cell));
+      }
+    }
+  };
+
+  Tables const tables;
+
+  /**
+   * @brief Move every row of a band to the next row, the last one wrapping around to the first
+   **/
+  inline Cells81 next_row(Cells81 cells)
+  {
+    return (cells.left<9>() | cells.right<18>()) & Cells81::bands(BAND);
+  }
+
+  /**
+   * @brief Move every row segment to the same row of the next block, wrapping around
+   **/
+  inline Cells81 next_block(Cells81 cells)
+  {
+    return (cells.left<3>() & Cells81::bands(0x1F8 * STACK))
+      | (cells.right<6>() & Cells81::bands(0x7 * STACK));
+  }
+
+  /**
+   * @brief Move every cell of a band's first row to the next column of its block, wrapping around
+   **/
+  inline Cells81 next_column(Cells81 cells)
+  {
+    return (cells.left<1>() & Cells81::bands(0x1B6)) | (cells.right<2>() & Cells81::bands(0x49));
+  }
+
+  /**
+   * @brief The number of cells in a set
+   **/
+  inline std::size_t population(Cells81 const& cells)
+  {
+    return __builtin_popcount(cells.band(0)) + __builtin_popcount(cells.band(1)) +
+           __builtin_popcount(cells.band(2));
+  }
+}
+
+BitboardSolver::BitboardSolver() : consistent(false), stats(nullptr), watchdog(nullptr)
+{
+  //every branch solves at least one cell, so the stack never needs more than one frame per cell
+  this->stack.reserve(81);
+}
+
+void BitboardSolver::watch(SolveStats* stats)
+{
+  this->stats = stats;
+}
+
+void BitboardSolver::guard(Watchdog* watchdog)
+{
+  this->watchdog = watchdog;
+}
+
+bool BitboardSolver::vectorized()
+{
+#if defined(__SSE2__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool BitboardSolver::load(Grid const& grid)
+{
+  State& state = this->initial;
+
+  for (int d = 0; d < 9; d++)
+  {
+    state.digits[d] = tables.all;
+  }
+
+  state.solved = Cells81();
+  this->consistent = true;
+
+  for (std::size_t cell = 0; cell < 81 && this->consistent; cell++)
+  {
+    int a = grid.get(cell % 9, cell / 9);
+
+    //ignore incomplete elements
+    if (a != -1)
+    {
+      this->consistent = place(state, cell, a - 1);
+    }
+  }
+
+  this->solutions[0] = this->solutions[1] = state;
+  return this->consistent;
+}
+
+bool BitboardSolver::place(State& state, std::size_t cell, int d)
+{
+  Cells81 bit = Cells81::single(cell);
+
+  if (!state.digits[d].contains(cell) || state.solved.contains(cell))
+  {
+    return false;
+  }
+
+  for (int e = 0; e < 9; e++)
+  {
+    state.digits[e] = state.digits[e].minus(bit);
+  }
+
+  //the cell stays in its own digit's bitboard, which is how the digit is remembered
+  state.digits[d] = state.digits[d].minus(tables.peers[cell]) | bit;
+  state.solved |= bit;
+  return true;
+}
+
+bool BitboardSolver::propagate(State& state)
+{
+  bool changed = true;
+
+  while (changed)
+  {
+    changed = false;
+
+    if (!naked_singles(state, changed))
+    {
+      return false;
+    }
+
+    for (int d = 0; d < 9; d++)
+    {
+      if (!hidden_singles(state, d, changed))
+      {
+        return false;
+      }
+    }
+
+    //the singles are cheaper, so only look for locked candidates once they run dry
+    for (int d = 0; d < 9 && !changed; d++)
+    {
+      if (!locked_candidates(state, d, changed))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+bool BitboardSolver::naked_singles(State& state, bool& changed)
+{
+  //count the bitboards covering each cell, saturating at two
+  Cells81 once, twice;
+
+  for (int d = 0; d < 9; d++)
+  {
+    twice |= once & state.digits[d];
+    once |= state.digits[d];
+  }
+
+  Cells81 unsolved = tables.all.minus(state.solved);
+
+  if (!unsolved.minus(once).empty())
+  {
+    //a cell has no candidates left
+    return false;
+  }
+
+  for (Cells81 singles = unsolved.minus(twice); !singles.empty(); singles = singles.drop_lowest())
+  {
+    std::size_t cell = singles.lowest();
+    int d = 0;
+
+    while (d < 9 && !state.digits[d].contains(cell))
+    {
+      d++;
+    }
+
+    //an earlier single may have taken this cell's last candidate
+    if (d == 9 || !place(state, cell, d))
+    {
+      return false;
+    }
+
+    changed = true;
+  }
+
+  return true;
+}
+
+bool BitboardSolver::hidden_singles(State& state, int d, bool& changed)
+{
+  Cells81 board = state.digits[d], row = Cells81::bands(ROW);
+
+  //the three rows of every band
+  Cells81 r0 = board & row, r1 = board.right<9>() & row, r2 = board.right<18>() & row;
+
+  if (!(r0.zero_bands() | r1.zero_bands() | r2.zero_bands()).empty())
+  {
+    //a row has nowhere left for the digit
+    return false;
+  }
+
+  //x & (x - 1) is zero when x has a single bit
+  Cells81 found = (r0 & (r0 & r0.decrement()).zero_bands())
+    | (r1 & (r1 & r1.decrement()).zero_bands()).left<9>()
+    | (r2 & (r2 & r2.decrement()).zero_bands()).left<18>();
+
+  //the columns covered at least once, and at least twice, within every band
+  Cells81 once = r0 | r1 | r2, twice = (r0 & r1) | (r0 & r2) | (r1 & r2);
+
+  //the columns need all three bands, which is the only step that leaves the vector registers
+  std::uint32_t o0 = once.band(0), o1 = once.band(1), o2 = once.band(2);
+  std::uint32_t columns = o0 | o1 | o2;
+  std::uint32_t repeated = twice.band(0) | twice.band(1) | twice.band(2)
+    | (o0 & o1) | (o0 & o2) | (o1 & o2);
+
+  if (columns != ROW)
+  {
+    return false;
+  }
+
+  if (columns != repeated)
+  {
+    found |= board & Cells81::bands((columns & ~repeated) * STACK);
+  }
+
+  //fold the three columns of every block onto its first column: bits 0, 3, and 6 of the band
+  Cells81 heads = Cells81::bands(0x49);
+  Cells81 once1 = once.right<1>(), once2 = once.right<2>();
+  Cells81 blocks = (once | once1 | once2) & heads;
+  Cells81 crowded = (twice | twice.right<1>() | twice.right<2>()
+                     | (once & once1) | (once & once2) | (once1 & once2)) & heads;
+
+  if (!(blocks ^ heads).empty())
+  {
+    return false;
+  }
+
+  Cells81 lonely = blocks.minus(crowded);
+
+  if (!lonely.empty())
+  {
+    //spread every lonely block's head back over the block
+    lonely = lonely | lonely.left<1>() | lonely.left<2>();
+    found |= board & (lonely | lonely.left<9>() | lonely.left<18>());
+  }
+
+  for (found = found.minus(state.solved); !found.empty(); found = found.drop_lowest())
+  {
+    //the digit must go here, so losing the cell to an earlier single is a contradiction
+    if (!place(state, found.lowest(), d))
+    {
+      return false;
+    }
+
+    changed = true;
+  }
+
+  return true;
+}
+
+bool BitboardSolver::locked_candidates(State& state, int d, bool& changed)
+{
+  Cells81 board = state.digits[d];
+
+  //mark the row segments (three cells of a row within a block) that hold a cell for the digit
+  Cells81 segments = (board | board.right<1>() | board.right<2>()) & Cells81::bands(0x49 * STACK);
+
+  //pointing: a block's cells for the digit are on one row, so the rest of the row loses it
+  Cells81 pointing = segments.minus(next_row(segments) | next_row(next_row(segments)));
+  pointing = pointing | pointing.left<1>() | pointing.left<2>();
+
+  //claiming: a row's cells for the digit are in one block, so the rest of the block loses it
+  Cells81 claiming = segments.minus(next_block(segments) | next_block(next_block(segments)));
+  claiming = claiming | claiming.left<1>() | claiming.left<2>();
+
+  Cells81 eliminated = next_block(pointing) | next_block(next_block(pointing))
+    | next_row(claiming) | next_row(next_row(claiming));
+
+  //the same two rules along the columns, where the other blocks of a column are in other bands
+  Cells81 row = Cells81::bands(ROW);
+  Cells81 columns = (board | board.right<9>() | board.right<18>()) & row;
+  Cells81 lonely = columns.minus(next_column(columns) | next_column(next_column(columns)));
+  Cells81 banded = columns.minus(columns.rotate_bands<1>() | columns.rotate_bands<2>());
+  Cells81 lines = lonely.rotate_bands<1>() | lonely.rotate_bands<2>()
+    | next_column(banded) | next_column(next_column(banded));
+
+  eliminated |= lines | lines.left<9>() | lines.left<18>();
+
+  if (!(board & eliminated).empty())
+  {
+    //the hidden singles check will notice if a unit was emptied
+    state.digits[d] = board.minus(eliminated);
+    changed = true;
+  }
+
+  return true;
+}
+
+bool BitboardSolver::choose(State const& state, std::size_t& cell_out,
+                            unsigned int& digits_out)
+{
+  //count the candidates of every cell with bit-sliced adds, saturating at four
+  Cells81 at_least[5];
+
+  for (int d = 0; d < 9; d++)
+  {
+    Cells81 board = state.digits[d];
+
+    at_least[4] |= at_least[3] & board;
+    at_least[3] |= at_least[2] & board;
+    at_least[2] |= at_least[1] & board;
+    at_least[1] |= board;
+  }
+
+  Cells81 unsolved = tables.all.minus(state.solved);
+
+  if (unsolved.empty())
+  {
+    return false;
+  }
+
+  //propagation has already placed every single, so the fewest candidates is two or more
+  Cells81 best = unsolved.minus(at_least[3]);
+
+  if (best.empty())
+  {
+    best = unsolved.minus(at_least[4]);
+  }
+
+  if (best.empty())
+  {
+    best = unsolved;
+  }
+
+  cell_out = best.lowest();
+  digits_out = 0;
+
+  for (int d = 0; d < 9; d++)
+  {
+    if (state.digits[d].contains(cell_out))
+    {
+      digits_out |= 1u << d;
+    }
+  }
+
+  return true;
+}
+
+bool BitboardSolver::solve()
+{
+  return this->count(1) == 1;
+}
+
+std::size_t BitboardSolver::count(std::size_t limit, std::size_t budget)
+{
+  std::size_t found = 0, nodes = 0;
+  State state = this->initial;
+
+  this->stack.clear();
+
+  if (!this->consistent)
+  {
+    return 0;
+  }
+
+  while (true)
+  {
+    if (++nodes > budget)
+    {
+      return limit;
+    }
+
+    if (this->watchdog != nullptr && this->watchdog->expired())
+    {
+      return found;
+    }
+
+    std::size_t before = (this->stats != nullptr) ? population(state.solved) : 0;
+    bool alive = propagate(state);
+
+    if (this->stats != nullptr)
+    {
+      this->stats->nodes++;
+      this->stats->backtracks += !alive;
+      this->stats->propagations += alive ? population(state.solved) - before : 0;
+    }
+
+    if (alive)
+    {
+      std::size_t cell;
+      unsigned int digits;
+
+      if (!choose(state, cell, digits))
+      {
+        //every cell is solved, and the first two solutions are kept as witnesses
+        if (found < 2)
+        {
+          this->solutions[found] = state;
+        }
+
+        found++;
+
+        if (found >= limit)
+        {
+          return found;
+        }
+      }
+      else
+      {
+        Frame frame;
+        frame.state = state;
+        frame.cell = cell;
+        frame.digits = digits;
+        this->stack.push_back(frame);
+
+        if (this->stats != nullptr)
+        {
+          this->stats->max_depth = std::max<std::uint64_t>(this->stats->max_depth,
+                                                           this->stack.size());
+        }
+      }
+    }
+
+    //move on to the next digit of the deepest branch that has any left
+    bool advanced = false;
+
+    while (!this->stack.empty() && !advanced)
+    {
+      Frame& frame = this->stack.back();
+
+      if (frame.digits != 0)
+      {
+        int d = __builtin_ctz(frame.digits);
+        frame.digits &= frame.digits - 1;
+
+        state = frame.state;
+        advanced = place(state, frame.cell, d);
+
+        if (!advanced && this->stats != nullptr)
+        {
+          this->stats->backtracks++;
+        }
+      }
+      else
+      {
+        this->stack.pop_back();
+      }
+    }
+
+    if (!advanced)
+    {
+      //the whole tree has been explored
+      return found;
+    }
+  }
+}
+
+void BitboardSolver::store(Grid& grid, std::size_t which) const
+{
+  State const& solution = this->solutions[which];
+
+  for (std::size_t cell = 0; cell < 81; cell++)
+  {
+    grid.set(cell % 9, cell / 9, -1);
+  }
+
+  for (int d = 0; d < 9; d++)
+  {
+    Cells81 placed = solution.digits[d] & solution.solved;
+
+    for (; !placed.empty(); placed = placed.drop_lowest())
+    {
+      std::size_t cell = placed.lowest();
+      grid.set(cell % 9, cell / 9, d + 1);
+    }
+  }
+}
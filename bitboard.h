@@ -0,0 +1,484 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "grid.h"
+#include "stats.h"
+#include "watchdog.h"
+
+/**
+ * @brief A set of cells of a 9*9 board, stored as a bitboard in a 128-bit register
+ *
+ * The board is split into three bands of three rows each, and each band is stored in its own
+ * 32-bit lane: row r, column c is bit (r % 3) * 9 + c of lane r / 3, and the fourth lane is always
+ * zero. With this layout, the rows, the columns, and the blocks of all three bands can be examined
+ * at once with a few shifts and masks, one band per lane.
+ *
+ * When the compiler targets SSE2, which every x86-64 processor has, the lanes live in an XMM
+ * register and every operation is a single vector instruction. Otherwise the lanes fall back to an
+ * array of four 32-bit integers, and the same operations run one lane at a time.
+ **/
+class Cells81
+{
+public:
+  /**
+   * @brief The empty set
+   **/
+  Cells81();
+  /**
+   * @brief The set with the given bits in each band
+   **/
+  Cells81(std::uint32_t band0, std::uint32_t band1, std::uint32_t band2);
+
+  /**
+   * @brief The set containing only one cell
+   *
+   * @param cell The row-major index of the cell.
+   **/
+  static Cells81 single(std::size_t cell);
+  /**
+   * @brief The set with the same bits in all three bands
+   **/
+  static Cells81 bands(std::uint32_t bits);
+
+  Cells81 operator &(Cells81 const& other) const;
+  Cells81 operator |(Cells81 const& other) const;
+  Cells81 operator ^(Cells81 const& other) const;
+  Cells81& operator &=(Cells81 const& other);
+  Cells81& operator |=(Cells81 const& other);
+  /**
+   * @brief The cells of this set that are not in another set
+   **/
+  Cells81 minus(Cells81 const& other) const;
+
+  /**
+   * @brief Shift each band to the right or to the left
+   **/
+  template <int K> Cells81 right() const;
+  template <int K> Cells81 left() const;
+  /**
+   * @brief Move band (b + K) % 3 into band b
+   **/
+  template <int K> Cells81 rotate_bands() const;
+  /**
+   * @brief Subtract one from each band
+   **/
+  Cells81 decrement() const;
+  /**
+   * @brief All ones in the bands that are zero, and zero in the others
+   **/
+  Cells81 zero_bands() const;
+
+  bool empty() const;
+  bool contains(std::size_t cell) const;
+  /**
+   * @brief The bits of one band
+   **/
+  std::uint32_t band(std::size_t b) const;
+  /**
+   * @brief The row-major index of the lowest cell in a non-empty set
+   **/
+  std::size_t lowest() const;
+  /**
+   * @brief Remove the lowest cell from a non-empty set
+   **/
+  Cells81 drop_lowest() const;
+
+private:
+#if defined(__SSE2__)
+  explicit Cells81(__m128i bits);
+  __m128i bits;
+#else
+  std::uint32_t lanes[4];
+#endif
+};
+
+#if defined(__SSE2__)
+
+inline Cells81::Cells81() : bits(_mm_setzero_si128())
+{
+}
+
+inline Cells81::Cells81(std::uint32_t band0, std::uint32_t band1, std::uint32_t band2)
+  : bits(_mm_set_epi32(0, int(band2), int(band1), int(band0)))
+{
+}
+
+inline Cells81::Cells81(__m128i bits) : bits(bits)
+{
+}
+
+inline Cells81 Cells81::operator &(Cells81 const& other) const
+{
+  return Cells81(_mm_and_si128(this->bits, other.bits));
+}
+
+inline Cells81 Cells81::operator |(Cells81 const& other) const
+{
+  return Cells81(_mm_or_si128(this->bits, other.bits));
+}
+
+inline Cells81 Cells81::operator ^(Cells81 const& other) const
+{
+  return Cells81(_mm_xor_si128(this->bits, other.bits));
+}
+
+inline Cells81 Cells81::minus(Cells81 const& other) const
+{
+  return Cells81(_mm_andnot_si128(other.bits, this->bits));
+}
+
+template <int K>
+inline Cells81 Cells81::right() const
+{
+  return Cells81(_mm_srli_epi32(this->bits, K));
+}
+
+template <int K>
+inline Cells81 Cells81::left() const
+{
+  return Cells81(_mm_slli_epi32(this->bits, K));
+}
+
+template <int K>
+inline Cells81 Cells81::rotate_bands() const
+{
+  return Cells81(_mm_shuffle_epi32(this->bits, K == 1 ? _MM_SHUFFLE(3, 0, 2, 1)
+                                                      : _MM_SHUFFLE(3, 1, 0, 2)));
+}
+
+inline Cells81 Cells81::decrement() const
+{
+  return Cells81(_mm_sub_epi32(this->bits, _mm_set1_epi32(1)));
+}
+
+inline Cells81 Cells81::zero_bands() const
+{
+  //the fourth lane is always zero, so leave it out of the result
+  __m128i zero = _mm_cmpeq_epi32(this->bits, _mm_setzero_si128());
+  return Cells81(_mm_and_si128(zero, _mm_set_epi32(0, -1, -1, -1)));
+}
+
+inline bool Cells81::empty() const
+{
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(this->bits, _mm_setzero_si128())) == 0xFFFF;
+}
+
+inline std::uint32_t Cells81::band(std::size_t b) const
+{
+  switch (b)
+  {
+    case 0: { return std::uint32_t(_mm_cvtsi128_si32(this->bits)); }
+    case 1: { return std::uint32_t(_mm_cvtsi128_si32(_mm_shuffle_epi32(this->bits, 1))); }
+    default: { return std::uint32_t(_mm_cvtsi128_si32(_mm_shuffle_epi32(this->bits, 2))); }
+  }
+}
+
+#else
+
+inline Cells81::Cells81()
+{
+  this->lanes[0] = this->lanes[1] = this->lanes[2] = this->lanes[3] = 0;
+}
+
+inline Cells81::Cells81(std::uint32_t band0, std::uint32_t band1, std::uint32_t band2)
+{
+  this->lanes[0] = band0;
+  this->lanes[1] = band1;
+  this->lanes[2] = band2;
+  this->lanes[3] = 0;
+}
+
+inline Cells81 Cells81::operator &(Cells81 const& other) const
+{
+  return Cells81(this->lanes[0] & other.lanes[0], this->lanes[1] & other.lanes[1],
+                 this->lanes[2] & other.lanes[2]);
+}
+
+inline Cells81 Cells81::operator |(Cells81 const& other) const
+{
+  return Cells81(this->lanes[0] | other.lanes[0], this->lanes[1] | other.lanes[1],
+                 this->lanes[2] | other.lanes[2]);
+}
+
+inline Cells81 Cells81::operator ^(Cells81 const& other) const
+{
+  return Cells81(this->lanes[0] ^ other.lanes[0], this->lanes[1] ^ other.lanes[1],
+                 this->lanes[2] ^ other.lanes[2]);
+}
+
+inline Cells81 Cells81::minus(Cells81 const& other) const
+{
+  return Cells81(this->lanes[0] & ~other.lanes[0], this->lanes[1] & ~other.lanes[1],
+                 this->lanes[2] & ~other.lanes[2]);
+}
+
+template <int K>
+inline Cells81 Cells81::right() const
+{
+  return Cells81(this->lanes[0] >> K, this->lanes[1] >> K, this->lanes[2] >> K);
+}
+
+template <int K>
+inline Cells81 Cells81::left() const
+{
+  return Cells81(this->lanes[0] << K, this->lanes[1] << K, this->lanes[2] << K);
+}
+
+template <int K>
+inline Cells81 Cells81::rotate_bands() const
+{
+  return Cells81(this->lanes[K % 3], this->lanes[(1 + K) % 3], this->lanes[(2 + K) % 3]);
+}
+
+inline Cells81 Cells81::decrement() const
+{
+  return Cells81(this->lanes[0] - 1, this->lanes[1] - 1, this->lanes[2] - 1);
+}
+
+inline Cells81 Cells81::zero_bands() const
+{
+  return Cells81(this->lanes[0] == 0 ? ~0u : 0, this->lanes[1] == 0 ? ~0u : 0,
+                 this->lanes[2] == 0 ? ~0u : 0);
+}
+
+inline bool Cells81::empty() const
+{
+  return (this->lanes[0] | this->lanes[1] | this->lanes[2]) == 0;
+}
+
+inline std::uint32_t Cells81::band(std::size_t b) const
+{
+  return this->lanes[b];
+}
+
+#endif
+
+inline Cells81 Cells81::single(std::size_t cell)
+{
+  std::size_t row = cell / 9, bit = (row % 3) * 9 + cell % 9;
+  std::uint32_t mask = std::uint32_t(1) << bit;
+
+  switch (row / 3)
+  {
+    case 0: { return Cells81(mask, 0, 0); }
+    case 1: { return Cells81(0, mask, 0); }
+    default: { return Cells81(0, 0, mask); }
+  }
+}
+
+inline Cells81 Cells81::bands(std::uint32_t bits)
+{
+  return Cells81(bits, bits, bits);
+}
+
+inline Cells81& Cells81::operator &=(Cells81 const& other)
+{
+  return *this = *this & other;
+}
+
+inline Cells81& Cells81::operator |=(Cells81 const& other)
+{
+  return *this = *this | other;
+}
+
+inline bool Cells81::contains(std::size_t cell) const
+{
+  std::size_t row = cell / 9;
+  return ((this->band(row / 3) >> ((row % 3) * 9 + cell % 9)) & 1) != 0;
+}
+
+inline std::size_t Cells81::lowest() const
+{
+  for (std::size_t b = 0; b < 3; b++)
+  {
+    std::uint32_t bits = this->band(b);
+
+    if (bits != 0)
+    {
+      std::size_t bit = __builtin_ctz(bits);
+      return (b * 3 + bit / 9) * 9 + bit % 9;
+    }
+  }
+
+  return 81;
+}
+
+inline Cells81 Cells81::drop_lowest() const
+{
+  return this->minus(Cells81::single(this->lowest()));
+}
+
+/**
+ * @brief A solver dedicated to 9*9 boards, working on one bitboard per digit
+ *
+ * Instead of storing a value per cell, the solver keeps nine bitboards: bitboard d holds the cells
+ * where the digit d+1 may go, including the cell where it has already been placed, if any. Placing
+ * a digit clears the cell's peers from that digit's bitboard and clears the cell from every other
+ * bitboard, which is ten vector operations. Propagation works on whole bitboards as well:
+ *
+ *  - naked singles: the unsolved cells covered by exactly one bitboard, found by counting the
+ *    bitboards covering each cell with bit-sliced adds;
+ *  - hidden singles: the rows, columns, and blocks where a digit's bitboard has a single cell,
+ *    found for all three bands at once;
+ *  - locked candidates: a digit confined to one line of a block is removed from the rest of that
+ *    line, and a digit confined to one block of a line is removed from the rest of the block.
+ *
+ * Any unit left without a cell for some digit, and any unsolved cell left without a digit, is a
+ * contradiction. When propagation stalls, the solver branches on an unsolved cell with the fewest
+ * candidates. The states along the current branch are kept in a stack that is allocated once, so
+ * the search does not touch the heap.
+ **/
+class BitboardSolver
+{
+public:
+  BitboardSolver();
+
+  /**
+   * @brief Fill in some statistics during every search from now on (see SolveStats)
+   *
+   * @param stats Where to add the counts, or nullptr to stop counting.
+   **/
+  void watch(SolveStats* stats);
+  /**
+   * @brief Keep every search from now on within some limits (see Watchdog)
+   *
+   * @param watchdog The limits, or nullptr for none.
+   **/
+  void guard(Watchdog* watchdog);
+
+  /**
+   * @brief Whether the bitboards are using SIMD registers, or the scalar fallback
+   *
+   * @return bool Whether the solver was built with SSE2.
+   **/
+  static bool vectorized();
+
+  /**
+   * @brief Load a puzzle into the solver
+   *
+   * @param grid The Sudoku board. It must be a 9*9 board.
+   * @return bool Whether the known cells are consistent with each other.
+   **/
+  bool load(Grid const& grid);
+  /**
+   * @brief Search for a solution. If one is found, it can be retrieved with store().
+   *
+   * @return bool Whether the puzzle has a solution.
+   **/
+  bool solve();
+  /**
+   * @brief Count the solutions of the puzzle, stopping early once a limit is reached. The first
+   *        two solutions found can be retrieved with store().
+   *
+   * @param limit The number of solutions after which the search gives up.
+   * @param budget The number of nodes after which the search gives up, as if it had reached the
+   *               limit.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  std::size_t count(std::size_t limit, std::size_t budget = std::size_t(-1));
+  /**
+   * @brief Copy one of the first two solutions found (or the loaded puzzle, if there are not that
+   *        many) into a grid
+   *
+   * @param grid The grid to overwrite. It must be a 9*9 board.
+   * @param which 0 for the first solution, 1 for the second.
+   **/
+  void store(Grid& grid, std::size_t which = 0) const;
+
+private:
+  /**
+   * @brief Everything the search needs to know about a partially solved board
+   **/
+  struct State
+  {
+    /**
+     * @brief The cells where each digit may go, or has been placed.
+     **/
+    Cells81 digits[9];
+    /**
+     * @brief The solved cells.
+     **/
+    Cells81 solved;
+  };
+
+  /**
+   * @brief A state on the stack, and the digits left to try in the cell it branches on
+   **/
+  struct Frame
+  {
+    State state;
+    std::size_t cell;
+    unsigned int digits;
+  };
+
+  /**
+   * @brief Put a digit in an unsolved cell
+   *
+   * @return bool Whether the digit could still go in the cell.
+   **/
+  static bool place(State& state, std::size_t cell, int d);
+  /**
+   * @brief Apply the singles and locked candidates rules until they stop making progress
+   *
+   * @return bool Whether the state is still consistent.
+   **/
+  static bool propagate(State& state);
+  static bool naked_singles(State& state, bool& changed);
+  static bool hidden_singles(State& state, int d, bool& changed);
+  static bool locked_candidates(State& state, int d, bool& changed);
+  /**
+   * @brief Pick the unsolved cell with the fewest candidates
+   *
+   * @return bool Whether there are any unsolved cells left.
+   **/
+  static bool choose(State const& state, std::size_t& cell_out, unsigned int& digits_out);
+
+  /**
+   * @brief The puzzle as it was loaded, and the first two solutions found.
+   **/
+  State initial, solutions[2];
+  /**
+   * @brief Whether the loaded puzzle is consistent.
+   **/
+  bool consistent;
+  /**
+   * @brief The states along the current branch. There is at most one per cell.
+   **/
+  std::vector<Frame> stack;
+  /**
+   * @brief Where to count what the searches go through, if anywhere.
+   **/
+  SolveStats* stats;
+  /**
+   * @brief The limits of the searches, if any.
+   **/
+  Watchdog* watchdog;
+};
+
+#endif // BITBOARD_H
@@ -0,0 +1,317 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BITS_H
+#define BITS_H
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief A color mask that is wider than any integer, for boards of more than 64*64 cells
+ *
+ * The mask is an array of 64-bit words, least significant word first, with the operators that the
+ * solvers use on integer masks, each applied a word at a time. That way the same templates can use
+ * either kind of mask. Integers convert to Bitsets, so that a mask can still be cleared with 0 or
+ * compared with it.
+ *
+ * @tparam WORDS The number of 64-bit words.
+ **/
+template <std::size_t WORDS>
+class Bitset
+{
+public:
+  Bitset(std::uint64_t low = 0) : words()
+  {
+    this->words[0] = low;
+  }
+
+  /**
+   * @brief One of the words of the mask, the least significant one being word 0
+   **/
+  std::uint64_t word(std::size_t w) const
+  {
+    return this->words[w];
+  }
+
+  Bitset operator ~() const
+  {
+    Bitset flipped;
+
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      flipped.words[w] = ~this->words[w];
+    }
+
+    return flipped;
+  }
+
+  Bitset& operator &=(Bitset const& other)
+  {
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      this->words[w] &= other.words[w];
+    }
+
+    return *this;
+  }
+
+  Bitset& operator |=(Bitset const& other)
+  {
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      this->words[w] |= other.words[w];
+    }
+
+    return *this;
+  }
+
+  Bitset& operator ^=(Bitset const& other)
+  {
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      this->words[w] ^= other.words[w];
+    }
+
+    return *this;
+  }
+
+  Bitset operator <<(std::size_t k) const
+  {
+    Bitset shifted;
+    std::size_t const skip = k / 64, bits = k % 64;
+
+    for (std::size_t w = skip; w < WORDS; w++)
+    {
+      shifted.words[w] = this->words[w - skip] << bits;
+
+      //pick up the bits that cross over from the word below
+      if (bits != 0 && w > skip)
+      {
+        shifted.words[w] |= this->words[w - skip - 1] >> (64 - bits);
+      }
+    }
+
+    return shifted;
+  }
+
+  friend Bitset operator &(Bitset a, Bitset const& b)
+  {
+    return a &= b;
+  }
+
+  friend Bitset operator |(Bitset a, Bitset const& b)
+  {
+    return a |= b;
+  }
+
+  friend Bitset operator ^(Bitset a, Bitset const& b)
+  {
+    return a ^= b;
+  }
+
+  friend Bitset operator -(Bitset a, Bitset const& b)
+  {
+    std::uint64_t borrow = 0;
+
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      std::uint64_t x = a.words[w], y = b.words[w];
+      a.words[w] = x - y - borrow;
+      borrow = (x < y || x - y < borrow) ? 1 : 0;
+    }
+
+    return a;
+  }
+
+  friend bool operator ==(Bitset const& a, Bitset const& b)
+  {
+    std::uint64_t differ = 0;
+
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      differ |= a.words[w] ^ b.words[w];
+    }
+
+    return differ == 0;
+  }
+
+  friend bool operator !=(Bitset const& a, Bitset const& b)
+  {
+    return !(a == b);
+  }
+
+private:
+  std::uint64_t words[WORDS];
+};
+
+/**
+ * @brief The masks of the boards that have more than 64 colors: up to 128, which covers 81*81,
+ *        100*100 and 121*121 boards, and up to 192, which covers 144*144 boards
+ **/
+typedef Bitset<2> Mask128;
+typedef Bitset<3> Mask192;
+
+/**
+ * @brief Bit manipulation helpers for the color masks used throughout the solvers
+ *
+ * A color mask is an unsigned integer where the least significant bit corresponds to the color 1,
+ * the next bit corresponds to the color 2, and so on. These helpers wrap the compiler intrinsics so
+ * that the solvers can walk the set bits of a mask without testing every color one at a time. They
+ * work on any unsigned integer type, so that small boards can use narrow masks, and on Bitsets for
+ * the boards that have more colors than a 64-bit integer holds. The type defaults to a 64-bit mask,
+ * which is wide enough for every board up to 64*64.
+ **/
+class Bits
+{
+public:
+  /**
+   * @brief The mask with a single bit set for the given color
+   *
+   * @param i The color, between 1 and the width of the mask.
+   * @return Mask The mask for that color.
+   **/
+  template <class Mask = std::uint_fast64_t>
+  static Mask color_bit(int i)
+  {
+    return Mask(Mask(1) << (i - 1));
+  }
+
+  /**
+   * @brief The mask with the bits for the colors 1-n set
+   *
+   * @param n The number of colors, between 0 and the width of the mask.
+   * @return Mask The mask containing every color.
+   **/
+  template <class Mask = std::uint_fast64_t>
+  static Mask all_colors(std::size_t n)
+  {
+    return (n >= 8 * sizeof(Mask)) ? Mask(~Mask(0)) : Mask((Mask(1) << n) - 1);
+  }
+
+  /**
+   * @brief The lowest color contained in a mask
+   *
+   * @param mask A non-zero color mask.
+   * @return int The lowest color in the mask.
+   **/
+  template <class Mask>
+  static int lowest_color(Mask mask)
+  {
+    if (sizeof(Mask) <= sizeof(unsigned int))
+    {
+      return __builtin_ctz((unsigned int)mask) + 1;
+    }
+    else
+    {
+      return __builtin_ctzll((unsigned long long)mask) + 1;
+    }
+  }
+
+  template <std::size_t WORDS>
+  static int lowest_color(Bitset<WORDS> const& mask)
+  {
+    std::size_t w = 0;
+
+    while (mask.word(w) == 0)
+    {
+      w++;
+    }
+
+    return int(64 * w) + __builtin_ctzll(mask.word(w)) + 1;
+  }
+
+  /**
+   * @brief Remove the lowest color from a mask
+   *
+   * @param mask A non-zero color mask.
+   * @return Mask The mask without its lowest color.
+   **/
+  template <class Mask>
+  static Mask drop_lowest(Mask mask)
+  {
+    return Mask(mask & (mask - 1));
+  }
+
+  template <std::size_t WORDS>
+  static Bitset<WORDS> drop_lowest(Bitset<WORDS> const& mask)
+  {
+    std::size_t w = 0;
+
+    while (w < WORDS && mask.word(w) == 0)
+    {
+      w++;
+    }
+
+    //only the lowest non-zero word changes
+    return (w == WORDS) ? mask : mask ^ (Bitset<WORDS>(mask.word(w) & -mask.word(w)) << (64 * w));
+  }
+
+  /**
+   * @brief The number of colors contained in a mask
+   *
+   * @param mask A color mask.
+   * @return int The number of set bits.
+   **/
+  template <class Mask>
+  static int count(Mask mask)
+  {
+    if (sizeof(Mask) <= sizeof(unsigned int))
+    {
+      return __builtin_popcount((unsigned int)mask);
+    }
+    else
+    {
+      return __builtin_popcountll((unsigned long long)mask);
+    }
+  }
+
+  template <std::size_t WORDS>
+  static int count(Bitset<WORDS> const& mask)
+  {
+    int total = 0;
+
+    for (std::size_t w = 0; w < WORDS; w++)
+    {
+      total += __builtin_popcountll(mask.word(w));
+    }
+
+    return total;
+  }
+
+  /**
+   * @brief One 64-bit word of a mask, for storing masks of any width the same way (see Grid)
+   *
+   * @param mask A color mask.
+   * @param w The index of the word, the least significant one being word 0.
+   * @return std::uint64_t The colors 64*w+1 to 64*w+64 of the mask.
+   **/
+  template <class Mask>
+  static std::uint64_t word(Mask mask, std::size_t w)
+  {
+    return (w == 0) ? std::uint64_t(mask) : 0;
+  }
+
+  template <std::size_t WORDS>
+  static std::uint64_t word(Bitset<WORDS> const& mask, std::size_t w)
+  {
+    return (w < WORDS) ? mask.word(w) : 0;
+  }
+};
+
+#endif // BITS_H
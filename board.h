@@ -0,0 +1,539 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BOARD_H
+#define BOARD_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "bits.h"
+#include "geometry.h"
+#include "grid.h"
+
+/**
+ * @brief The order in which a search visits the uncolored cells of a board
+ **/
+enum class Branching
+{
+  /**
+   * @brief Visit the cells in row-major order.
+   **/
+  ROW_MAJOR,
+  /**
+   * @brief Visit the cell with the fewest colors left first, breaking ties by the number of
+   *        uncolored cells it shares a unit with (i.e., DSATUR).
+   **/
+  MOST_CONSTRAINED
+};
+
+/**
+ * @brief The state of a Sudoku board while it is being searched
+ *
+ * A board is a single copy of the puzzle that the solvers color in place. Besides the colors of
+ * the cells, it keeps the colors used by every row, column, and block, so that the colors a cell
+ * may use can be found without rescanning its units. Every cell that gets colored is pushed onto
+ * an undo trail, so backing out of a branch is a matter of remembering the length of the trail
+ * before the branch (mark()) and popping back to it afterwards (undo()). The buffers are allocated
+ * once, when the board is built, so neither the search nor loading another puzzle of the same size
+ * touches the heap.
+ *
+ * Cells are referred to by their row-major index (see FixedGeometry), and colors are stored as
+ * 1-n with 0 for an uncolored cell.
+ *
+ * @tparam Geometry The shape of the board (FixedGeometry or DynamicGeometry).
+ **/
+template <class Geometry>
+class BasicBoard
+{
+public:
+  typedef typename Geometry::mask_type mask_type;
+
+  /**
+   * @brief Build an empty board
+   *
+   * @param geometry The shape of the board. It must outlive the board.
+   **/
+  BasicBoard(Geometry const& geometry);
+
+  /**
+   * @brief Replace the contents of the board with a puzzle, and clear the undo trail
+   *
+   * @param grid The Sudoku board. It must have the right size, and it must not contain any repeated
+   *             colors in a unit.
+   **/
+  void load(Grid const& grid);
+  /**
+   * @brief Copy the colors of the board into a grid, using -1 for the uncolored cells. If the grid
+   *        keeps candidates (see Grid::has_candidates()), they are overwritten too: the colors an
+   *        uncolored cell may still use, and the color of a colored one.
+   *
+   * @param grid The grid to overwrite. It must have the same size as the board.
+   **/
+  void store(Grid& grid) const;
+
+  /**
+   * @brief The shape of the board
+   **/
+  Geometry const& shape() const;
+
+  /**
+   * @brief Get the color of a specific cell
+   *
+   * @param cell The index of the cell.
+   * @return int The color of the cell, or 0 if it has not been colored yet.
+   **/
+  int get(std::size_t cell) const;
+  /**
+   * @brief Tells you which colors a certain cell may use, using the same encoding as
+   *        Validator::good_colors().
+   *
+   * @param cell The index of the cell.
+   * @return mask_type The colors that do not appear in the cell's row, column, or block.
+   **/
+  mask_type candidates(std::size_t cell) const;
+
+  /**
+   * @brief Color an uncolored cell and record it on the undo trail
+   *
+   * @param cell The index of the cell.
+   * @param i The color of the cell. It must be one of the cell's candidates.
+   **/
+  void place(std::size_t cell, int i);
+
+  /**
+   * @brief The current length of the undo trail, to be handed back to undo() later
+   *
+   * @return std::size_t The number of cells colored so far.
+   **/
+  std::size_t mark() const;
+  /**
+   * @brief Uncolor every cell that was colored after a call to mark()
+   *
+   * @param mark The value returned by mark().
+   **/
+  void undo(std::size_t mark);
+
+  /**
+   * @brief Color every cell that is forced, until there are none left (i.e., until a fixpoint)
+   *
+   * Two rules are applied over and over again. A cell with a single color left must use that color
+   * (a naked single), and a color that only fits in a single cell of a row, a column, or a block
+   * must go in that cell (a hidden single). Along the way, the board is checked for contradictions:
+   * a cell with no colors left, or a color that fits nowhere in a unit that still needs it. Every
+   * cell colored here is recorded on the undo trail, so the caller can back out of it with undo().
+   *
+   * @return bool Whether the board is still consistent. If not, the search should backtrack.
+   **/
+  bool propagate();
+
+  /**
+   * @brief Find the next uncolored cell in row-major order
+   *
+   * @param from The cell to start looking from.
+   * @param cell_out The next uncolored cell.
+   * @return bool Whether we were able to find an uncolored cell.
+   **/
+  bool find_unknown(std::size_t from, std::size_t& cell_out) const;
+  /**
+   * @brief Find the uncolored cell with the fewest colors left (i.e., the highest saturation)
+   *
+   * Ties are broken by the degree of the cell in the uncolored part of the graph: the number of
+   * uncolored cells that share a row, a column, or a block with it. The search stops early if it
+   * finds a cell with no colors left, since there is no point in looking any further.
+   *
+   * @param cell_out The most constrained cell.
+   * @return bool Whether we were able to find an uncolored cell.
+   **/
+  bool find_most_constrained(std::size_t& cell_out) const;
+  /**
+   * @brief Find the next uncolored cell to branch on
+   *
+   * @param policy The order in which the cells should be visited.
+   * @param from The cell to start looking from (only used for ROW_MAJOR).
+   * @param cell_out The next cell.
+   * @return bool Whether we were able to find an uncolored cell.
+   **/
+  bool next_unknown(Branching policy, std::size_t from, std::size_t& cell_out) const;
+
+private:
+  /**
+   * @brief The number of uncolored cells sharing a unit with a cell
+   **/
+  std::size_t degree(std::size_t cell) const;
+  /**
+   * @brief Color every naked single on the board
+   *
+   * @param changed Set to true if any cell was colored.
+   * @return bool Whether the board is still consistent.
+   **/
+  bool propagate_naked_singles(bool& changed);
+  /**
+   * @brief Color every hidden single in a unit
+   *
+   * @param unit The index of the unit (see FixedGeometry).
+   * @param changed Set to true if any cell was colored.
+   * @return bool Whether the board is still consistent.
+   **/
+  bool propagate_hidden_singles(std::size_t unit, bool& changed);
+
+  /**
+   * @brief The shape of the board.
+   **/
+  Geometry const& geometry;
+  /**
+   * @brief The colors of the cells in row-major order, with 0 for the uncolored cells.
+   **/
+  std::vector<std::uint8_t> cells;
+  /**
+   * @brief The cells colored by place(), in the order they were colored.
+   **/
+  std::vector<std::uint16_t> trail;
+  /**
+   * @brief The colors used by every row, every column, and every block.
+   **/
+  std::vector<mask_type> row_used, column_used, block_used;
+};
+
+template <class Geometry>
+BasicBoard<Geometry>::BasicBoard(Geometry const& geometry)
+  : geometry(geometry), cells(geometry.cells(), 0), row_used(geometry.n(), 0),
+    column_used(geometry.n(), 0), block_used(geometry.n(), 0)
+{
+  //at most every cell gets colored, so the trail never has to grow during the search
+  this->trail.reserve(geometry.cells());
+}
+
+template <class Geometry>
+void BasicBoard<Geometry>::load(Grid const& grid)
+{
+  const std::size_t n = this->geometry.n();
+
+  this->trail.clear();
+  std::fill(this->row_used.begin(), this->row_used.end(), 0);
+  std::fill(this->column_used.begin(), this->column_used.end(), 0);
+  std::fill(this->block_used.begin(), this->block_used.end(), 0);
+
+  for (std::size_t cell = 0; cell < this->geometry.cells(); cell++)
+  {
+    int a = grid.get(cell % n, cell / n);
+
+    //ignore incomplete elements
+    if (a == -1)
+    {
+      this->cells[cell] = 0;
+    }
+    else
+    {
+      mask_type bit = Bits::color_bit<mask_type>(a);
+      this->cells[cell] = std::uint8_t(a);
+      this->row_used[this->geometry.row(cell)] |= bit;
+      this->column_used[this->geometry.column(cell)] |= bit;
+      this->block_used[this->geometry.block(cell)] |= bit;
+    }
+  }
+}
+
+template <class Geometry>
+void BasicBoard<Geometry>::store(Grid& grid) const
+{
+  const std::size_t n = this->geometry.n();
+
+  for (std::size_t cell = 0; cell < this->geometry.cells(); cell++)
+  {
+    int a = this->cells[cell];
+    grid.set(cell % n, cell / n, (a == 0) ? -1 : a);
+  }
+
+  if (grid.has_candidates())
+  {
+    const std::size_t words = grid.candidate_words();
+
+    for (std::size_t cell = 0; cell < this->geometry.cells(); cell++)
+    {
+      int a = this->cells[cell];
+      mask_type colors = (a == 0) ? this->candidates(cell) : Bits::color_bit<mask_type>(a);
+      std::uint64_t* masks = grid.candidates(cell % n, cell / n);
+
+      for (std::size_t w = 0; w < words; w++)
+      {
+        masks[w] = Bits::word(colors, w);
+      }
+    }
+  }
+}
+
+template <class Geometry>
+inline Geometry const& BasicBoard<Geometry>::shape() const
+{
+  return this->geometry;
+}
+
+template <class Geometry>
+inline int BasicBoard<Geometry>::get(std::size_t cell) const
+{
+  return this->cells[cell];
+}
+
+template <class Geometry>
+inline typename BasicBoard<Geometry>::mask_type BasicBoard<Geometry>::candidates(
+  std::size_t cell) const
+{
+  return mask_type(~(this->row_used[this->geometry.row(cell)]
+                     | this->column_used[this->geometry.column(cell)]
+                     | this->block_used[this->geometry.block(cell)]) & this->geometry.all());
+}
+
+template <class Geometry>
+inline void BasicBoard<Geometry>::place(std::size_t cell, int i)
+{
+  mask_type bit = Bits::color_bit<mask_type>(i);
+
+  this->cells[cell] = std::uint8_t(i);
+  this->row_used[this->geometry.row(cell)] |= bit;
+  this->column_used[this->geometry.column(cell)] |= bit;
+  this->block_used[this->geometry.block(cell)] |= bit;
+  this->trail.push_back(std::uint16_t(cell));
+}
+
+template <class Geometry>
+inline std::size_t BasicBoard<Geometry>::mark() const
+{
+  return this->trail.size();
+}
+
+template <class Geometry>
+inline void BasicBoard<Geometry>::undo(std::size_t mark)
+{
+  while (this->trail.size() > mark)
+  {
+    std::size_t cell = this->trail.back();
+    mask_type bit = mask_type(~Bits::color_bit<mask_type>(this->cells[cell]));
+
+    this->trail.pop_back();
+    this->cells[cell] = 0;
+    this->row_used[this->geometry.row(cell)] &= bit;
+    this->column_used[this->geometry.column(cell)] &= bit;
+    this->block_used[this->geometry.block(cell)] &= bit;
+  }
+}
+
+template <class Geometry>
+bool BasicBoard<Geometry>::propagate()
+{
+  bool changed = true;
+
+  //keep applying the rules until they stop coloring cells
+  while (changed)
+  {
+    changed = false;
+
+    if (!this->propagate_naked_singles(changed))
+    {
+      return false;
+    }
+
+    for (std::size_t unit = 0; unit < 3 * this->geometry.n(); unit++)
+    {
+      if (!this->propagate_hidden_singles(unit, changed))
+      {
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+template <class Geometry>
+bool BasicBoard<Geometry>::propagate_naked_singles(bool& changed)
+{
+  for (std::size_t cell = 0; cell < this->geometry.cells(); cell++)
+  {
+    if (this->cells[cell] != 0)
+    {
+      continue;
+    }
+
+    mask_type colors = this->candidates(cell);
+
+    if (colors == 0)
+    {
+      //this cell can't be colored at all
+      return false;
+    }
+    else if (Bits::drop_lowest(colors) == 0)
+    {
+      //this cell can only be colored one way
+      this->place(cell, Bits::lowest_color(colors));
+      changed = true;
+    }
+  }
+
+  return true;
+}
+
+template <class Geometry>
+bool BasicBoard<Geometry>::propagate_hidden_singles(std::size_t unit, bool& changed)
+{
+  std::uint16_t const* members = this->geometry.unit(unit);
+  mask_type placed = 0, once = 0, twice = 0;
+
+  //find out which colors are already used, and which colors fit in one or more uncolored cells
+  for (std::size_t k = 0; k < this->geometry.n(); k++)
+  {
+    int a = this->cells[members[k]];
+
+    if (a != 0)
+    {
+      placed |= Bits::color_bit<mask_type>(a);
+    }
+    else
+    {
+      mask_type colors = this->candidates(members[k]);
+      twice |= once & colors;
+      once |= colors;
+    }
+  }
+
+  //every color must either be used already or fit somewhere
+  if (mask_type(placed | once) != this->geometry.all())
+  {
+    return false;
+  }
+
+  //the colors that fit exactly once have to go in that one cell
+  for (mask_type hidden = once & ~twice; hidden != 0; hidden = Bits::drop_lowest(hidden))
+  {
+    int i = Bits::lowest_color(hidden);
+    mask_type bit = Bits::color_bit<mask_type>(i);
+    bool found = false;
+
+    for (std::size_t k = 0; k < this->geometry.n() && !found; k++)
+    {
+      //the cell may have been taken by another hidden single in the meantime
+      if (this->cells[members[k]] == 0 && (this->candidates(members[k]) & bit) != 0)
+      {
+        this->place(members[k], i);
+        found = true;
+      }
+    }
+
+    if (!found)
+    {
+      return false;
+    }
+
+    changed = true;
+  }
+
+  return true;
+}
+
+template <class Geometry>
+bool BasicBoard<Geometry>::find_unknown(std::size_t from, std::size_t& cell_out) const
+{
+  //find the next unknown node from where we left off, so we don't need to re-examine any elements
+  for (std::size_t cell = from; cell < this->geometry.cells(); cell++)
+  {
+    if (this->cells[cell] == 0)
+    {
+      cell_out = cell;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+template <class Geometry>
+bool BasicBoard<Geometry>::find_most_constrained(std::size_t& cell_out) const
+{
+  bool found = false;
+  int best_count = 0;
+  std::size_t best_degree = 0;
+
+  for (std::size_t cell = 0; cell < this->geometry.cells(); cell++)
+  {
+    if (this->cells[cell] != 0)
+    {
+      continue;
+    }
+
+    int count = Bits::count(this->candidates(cell));
+
+    if (!found || count < best_count)
+    {
+      found = true;
+      best_count = count;
+      best_degree = this->degree(cell);
+      cell_out = cell;
+
+      //nothing beats a dead end or a forced move, so stop looking
+      if (count <= 1)
+      {
+        return true;
+      }
+    }
+    else if (count == best_count)
+    {
+      //only work out the degree when it is needed to break a tie
+      std::size_t d = this->degree(cell);
+
+      if (d > best_degree)
+      {
+        best_degree = d;
+        cell_out = cell;
+      }
+    }
+  }
+
+  return found;
+}
+
+template <class Geometry>
+inline bool BasicBoard<Geometry>::next_unknown(Branching policy, std::size_t from,
+                                               std::size_t& cell_out) const
+{
+  if (policy == Branching::MOST_CONSTRAINED)
+  {
+    return this->find_most_constrained(cell_out);
+  }
+  else
+  {
+    return this->find_unknown(from, cell_out);
+  }
+}
+
+template <class Geometry>
+std::size_t BasicBoard<Geometry>::degree(std::size_t cell) const
+{
+  std::uint16_t const* peers = this->geometry.peers(cell);
+  std::size_t d = 0;
+
+  for (std::size_t k = 0; k < this->geometry.peer_count(); k++)
+  {
+    d += (this->cells[peers[k]] == 0);
+  }
+
+  return d;
+}
+
+#endif // BOARD_H
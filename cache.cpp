@@ -0,0 +1,126 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "cache.h"
+
+#include <chrono>
+
+SolutionCache::Metrics::Metrics()
+  : lookups(0), hits(0), insertions(0), evictions(0), entries(0), seconds(0)
+{
+}
+
+double SolutionCache::Metrics::hit_rate() const
+{
+  return (this->lookups > 0) ? double(this->hits) / this->lookups : 0;
+}
+
+double SolutionCache::Metrics::lookup_seconds() const
+{
+  return (this->lookups > 0) ? this->seconds / this->lookups : 0;
+}
+
+SolutionCache::SolutionCache(std::size_t capacity) : limit(capacity)
+{
+}
+
+bool SolutionCache::lookup(Grid& grid, CanonicalForm& form, SolveResult& result)
+{
+  auto start = std::chrono::steady_clock::now();
+  form.reduce(grid);
+
+  std::string solution;
+  bool hit = false;
+
+  {
+    std::lock_guard<std::mutex> guard(this->lock);
+    auto found = this->index.find(form.key());
+
+    if (found != this->index.end())
+    {
+      //move the entry to the front, where it will be dropped last
+      this->entries.splice(this->entries.begin(), this->entries, found->second);
+      solution = found->second->second;
+      hit = true;
+    }
+  }
+
+  if (hit)
+  {
+    result = solution.empty() ? SolveResult::UNSOLVABLE : SolveResult::SOLVED;
+
+    if (!solution.empty())
+    {
+      form.backward(solution, grid);
+    }
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  std::lock_guard<std::mutex> guard(this->lock);
+  this->counters.lookups++;
+  this->counters.hits += hit;
+  this->counters.seconds += elapsed.count();
+  return hit;
+}
+
+void SolutionCache::store(CanonicalForm const& form, Grid const& solution, SolveResult result)
+{
+  if (result == SolveResult::ABORTED || this->limit == 0)
+  {
+    return;
+  }
+
+  std::string cells;
+
+  if (result == SolveResult::SOLVED)
+  {
+    form.forward(solution, cells);
+  }
+
+  std::lock_guard<std::mutex> guard(this->lock);
+
+  //another thread may have solved the same puzzle in the meantime
+  if (this->index.count(form.key()) != 0)
+  {
+    return;
+  }
+
+  this->entries.emplace_front(form.key(), std::move(cells));
+  this->index[form.key()] = this->entries.begin();
+  this->counters.insertions++;
+
+  if (this->entries.size() > this->limit)
+  {
+    this->index.erase(this->entries.back().first);
+    this->entries.pop_back();
+    this->counters.evictions++;
+  }
+}
+
+SolutionCache::Metrics SolutionCache::metrics() const
+{
+  std::lock_guard<std::mutex> guard(this->lock);
+  Metrics snapshot = this->counters;
+  snapshot.entries = this->entries.size();
+  return snapshot;
+}
+
+std::size_t SolutionCache::capacity() const
+{
+  return this->limit;
+}
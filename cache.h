@@ -0,0 +1,124 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "canonical.h"
+#include "grid.h"
+#include "watchdog.h"
+
+/**
+ * @brief A bounded cache of solutions, shared by any number of threads, which recognizes puzzles
+ *        that are the same up to the symmetries of Sudoku
+ *
+ * The puzzles are looked up by their canonical form (see CanonicalForm), so a puzzle with its
+ * digits relabeled, its rows swapped within a band or its board transposed hits the entry of the
+ * original, and the cached solution is mapped back onto it. Puzzles with no solution are cached as
+ * well. Once the cache is full, the entry that was used the longest time ago is dropped. A puzzle
+ * with more than one solution gets whichever one was cached first.
+ **/
+class SolutionCache
+{
+public:
+  /**
+   * @brief How well the cache is doing
+   **/
+  struct Metrics
+  {
+    Metrics();
+
+    /**
+     * @brief The share of the lookups that were hits, or 0 if there were none.
+     **/
+    double hit_rate() const;
+    /**
+     * @brief The average time of a lookup in seconds, including the canonical form, or 0.
+     **/
+    double lookup_seconds() const;
+
+    std::uint64_t lookups, hits, insertions, evictions;
+    std::size_t entries;
+    /**
+     * @brief The time spent in all the lookups.
+     **/
+    double seconds;
+  };
+
+  /**
+   * @brief Create an empty cache
+   *
+   * @param capacity The most puzzles to keep.
+   **/
+  explicit SolutionCache(std::size_t capacity);
+
+  SolutionCache(SolutionCache const&) = delete;
+  SolutionCache& operator =(SolutionCache const&) = delete;
+
+  /**
+   * @brief Look up a puzzle
+   *
+   * @param grid The puzzle, which is replaced by its solution on a hit.
+   * @param form Set to the canonical form of the puzzle, which can be passed to store() after a
+   *        miss.
+   * @param result Set to SolveResult::SOLVED or SolveResult::UNSOLVABLE on a hit.
+   * @return bool Whether the puzzle was found.
+   **/
+  bool lookup(Grid& grid, CanonicalForm& form, SolveResult& result);
+  /**
+   * @brief Remember how a puzzle turned out. Aborted solves are not remembered, since they might
+   *        have finished with more time.
+   *
+   * @param form The canonical form of the puzzle, from lookup().
+   * @param solution The solution of the puzzle, if it has one.
+   * @param result How the solve turned out.
+   **/
+  void store(CanonicalForm const& form, Grid const& solution, SolveResult result);
+
+  /**
+   * @brief A snapshot of the metrics
+   **/
+  Metrics metrics() const;
+  std::size_t capacity() const;
+
+private:
+  /**
+   * @brief The canonical form of a puzzle, and its solution in the same coordinates (or nothing,
+   *        if it has none), with the most recently used first.
+   **/
+  typedef std::list<std::pair<std::string, std::string>> Entries;
+
+  std::size_t limit;
+  Entries entries;
+  std::unordered_map<std::string, Entries::iterator> index;
+  Metrics counters;
+  /**
+   * @brief Guards everything above.
+   **/
+  mutable std::mutex lock;
+};
+
+#endif // CACHE_H
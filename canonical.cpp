@@ -0,0 +1,259 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "canonical.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+  /**
+   * @brief Scramble a value, so that sums of scrambled values rarely collide
+   **/
+  std::uint64_t mix(std::uint64_t x)
+  {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+}
+
+CanonicalForm::CanonicalForm() : dim(0), root(0)
+{
+  std::memset(this->relabel, 0, sizeof(this->relabel));
+  std::memset(this->restore, 0, sizeof(this->restore));
+}
+
+void CanonicalForm::reduce(Grid const& grid)
+{
+  std::size_t const n = grid.n();
+  std::uint8_t const* cells = grid.cells();
+
+  this->dim = n;
+  this->root = 1;
+
+  while (this->root * this->root < n)
+  {
+    this->root++;
+  }
+
+  //count the clues of every line and the copies of every digit, which no symmetry changes
+  this->digits.assign(n + 1, 0);
+  this->row_clues.assign(n, 0);
+  this->column_clues.assign(n, 0);
+  this->clues.clear();
+
+  for (std::size_t i = 0; i < n * n; i++)
+  {
+    if (cells[i] != Grid::UNKNOWN)
+    {
+      this->digits[cells[i]]++;
+      this->row_clues[i / n]++;
+      this->column_clues[i % n]++;
+      this->clues.push_back(std::uint16_t(i));
+    }
+  }
+
+  //a line is described by the clues it holds: the clues of the line crossing it there, and the
+  //copies of the digit, in any order
+  this->row_signatures.assign(n, 0);
+  this->column_signatures.assign(n, 0);
+
+  for (std::uint16_t i : this->clues)
+  {
+    std::size_t y = i / n, x = i % n, copies = this->digits[cells[i]];
+    this->row_signatures[y] += mix((this->column_clues[x] << 8) | copies);
+    this->column_signatures[x] += mix((this->row_clues[y] << 8) | copies);
+  }
+
+  this->arrange(this->row_signatures, this->row_order);
+  this->arrange(this->column_signatures, this->column_order);
+
+  this->lay_out(cells, false, true);
+  this->lay_out(cells, true, false);
+
+  for (std::size_t d = 0; d <= n; d++)
+  {
+    this->restore[this->relabel[d]] = std::uint8_t(d);
+  }
+}
+
+void CanonicalForm::arrange(std::vector<std::uint64_t> const& signatures,
+                            std::vector<std::uint16_t>& order)
+{
+  std::size_t const n = this->dim, root = this->root;
+  std::vector<std::uint64_t>& groups = this->group_signatures;
+  std::vector<std::uint16_t>& group_order = this->group_order;
+
+  groups.assign(root, 0);
+  group_order.resize(root);
+
+  for (std::size_t i = 0; i < n; i++)
+  {
+    groups[i / root] += mix(signatures[i]);
+  }
+
+  //lines (and groups) with the same signature keep their order
+  for (std::size_t g = 0; g < root; g++)
+  {
+    group_order[g] = std::uint16_t(g);
+  }
+
+  std::sort(group_order.begin(), group_order.end(), [&groups](std::uint16_t a, std::uint16_t b)
+  {
+    return groups[a] < groups[b] || (groups[a] == groups[b] && a < b);
+  });
+
+  order.resize(n);
+
+  for (std::size_t g = 0; g < root; g++)
+  {
+    std::uint16_t* lines = &order[g * root];
+
+    for (std::size_t k = 0; k < root; k++)
+    {
+      lines[k] = std::uint16_t(group_order[g] * root + k);
+    }
+
+    std::sort(lines, lines + root, [&signatures](std::uint16_t a, std::uint16_t b)
+    {
+      return signatures[a] < signatures[b] || (signatures[a] == signatures[b] && a < b);
+    });
+  }
+}
+
+void CanonicalForm::lay_out(std::uint8_t const* cells, bool transposed, bool first)
+{
+  std::size_t const n = this->dim;
+
+  //the rows of the transpose are the columns of the board, and a step along one of its rows is a
+  //step down a column of the board
+  std::uint16_t const* rows = transposed ? this->column_order.data() : this->row_order.data();
+  std::uint16_t const* columns = transposed ? this->row_order.data() : this->column_order.data();
+  std::size_t const row_stride = transposed ? 1 : n, column_stride = transposed ? n : 1;
+
+  this->candidate.resize(n * n);
+  this->candidate_source.resize(n * n);
+  std::memset(this->candidate_relabel, 0, sizeof(this->candidate_relabel));
+
+  char* out = &this->candidate[0];
+  std::uint16_t* source = this->candidate_source.data();
+  std::uint16_t* offsets = this->offsets;
+  std::uint8_t* relabel = this->candidate_relabel;
+  char const* best = this->form.data();
+  std::uint8_t next = 1;
+
+  for (std::size_t c = 0; c < n; c++)
+  {
+    offsets[c] = std::uint16_t(columns[c] * column_stride);
+  }
+
+  //once the layout is known to be smaller than the best one so far, there is nothing to compare
+  bool smaller = first;
+
+  for (std::size_t r = 0; r < n; r++)
+  {
+    std::size_t base = rows[r] * row_stride;
+
+    for (std::size_t c = 0; c < n; c++)
+    {
+      std::size_t cell = base + offsets[c], i = r * n + c;
+      std::uint8_t value = cells[cell], label = relabel[value];
+
+      //number a digit the first time it is seen, without a branch, since the clues are scattered
+      //at random; the label of an unknown cell stays 0
+      bool fresh = (label == 0) & (value != Grid::UNKNOWN);
+      label = fresh ? next : label;
+      next += fresh;
+      relabel[value] = label;
+
+      out[i] = char(label);
+      source[i] = std::uint16_t(cell);
+
+      if (!smaller && out[i] != best[i])
+      {
+        //the first difference decides
+        if (std::uint8_t(out[i]) > std::uint8_t(best[i]))
+        {
+          return;
+        }
+
+        smaller = true;
+      }
+    }
+  }
+
+  //a layout equal to the best one is not worth keeping
+  if (!smaller)
+  {
+    return;
+  }
+
+  //the digits that are not on the board get the labels that are left
+  for (std::size_t d = 1; d <= n; d++)
+  {
+    if (relabel[d] == 0)
+    {
+      relabel[d] = next++;
+    }
+  }
+
+  this->form.swap(this->candidate);
+  this->source.swap(this->candidate_source);
+  std::memcpy(this->relabel, relabel, sizeof(this->relabel));
+}
+
+std::size_t CanonicalForm::n() const
+{
+  return this->dim;
+}
+
+std::string const& CanonicalForm::key() const
+{
+  return this->form;
+}
+
+void CanonicalForm::forward(Grid const& grid, std::string& cells) const
+{
+  std::uint8_t const* board = grid.cells();
+  cells.resize(this->source.size());
+
+  for (std::size_t i = 0; i < this->source.size(); i++)
+  {
+    cells[i] = char(this->relabel[board[this->source[i]]]);
+  }
+}
+
+void CanonicalForm::backward(std::string const& cells, Grid& grid) const
+{
+  std::size_t const n = this->dim;
+
+  if (grid.n() != n)
+  {
+    grid.reset(n);
+  }
+
+  for (std::size_t i = 0; i < this->source.size(); i++)
+  {
+    std::size_t cell = this->source[i];
+    grid.set(cell % n, cell / n, this->restore[std::uint8_t(cells[i])]);
+  }
+}
@@ -0,0 +1,119 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CANONICAL_H
+#define CANONICAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "grid.h"
+
+/**
+ * @brief A board reduced to a canonical form under the symmetries of Sudoku, along with the
+ *        transformation that takes it there
+ *
+ * Relabeling the digits, permuting the bands, the rows within a band, the stacks and the columns
+ * within a stack, and transposing the board all turn a puzzle into one that is just as hard, with
+ * a solution that is transformed the same way. Two puzzles with the same canonical form are
+ * related by such a transformation, so the solution of one can be mapped onto the other through
+ * backward().
+ *
+ * Finding the lexicographically smallest form would mean searching through millions of
+ * transformations, which costs far more than solving the puzzle. Instead, every row and column
+ * gets a signature that the symmetries cannot change, made from the number of clues in the lines
+ * crossing it and the number of times each of its digits appears on the board. The bands, rows,
+ * stacks and columns are sorted by their signatures, the smaller of the board and its transpose is
+ * kept, and the digits are numbered in the order they first appear. That takes a few passes over
+ * the cells. When two lines have the same signature, they keep their order, so some equivalent
+ * puzzles get different forms: a cache in front of the solver misses them, but it never returns a
+ * wrong solution, since equal forms are always equivalent.
+ **/
+class CanonicalForm
+{
+public:
+  CanonicalForm();
+
+  /**
+   * @brief Reduce a board to its canonical form
+   *
+   * @param grid The board, which may be partially filled in.
+   **/
+  void reduce(Grid const& grid);
+
+  /**
+   * @brief The side length of the board that was reduced
+   **/
+  std::size_t n() const;
+  /**
+   * @brief The canonical form, with one byte per cell in row-major order (see Grid::cells())
+   **/
+  std::string const& key() const;
+  /**
+   * @brief Transform another board of the same size the same way, such as the solution of the
+   *        board that was reduced
+   *
+   * @param grid The board.
+   * @param cells Set to the transformed board, with one byte per cell in row-major order.
+   **/
+  void forward(Grid const& grid, std::string& cells) const;
+  /**
+   * @brief Undo the transformation, such as for the solution of the canonical form
+   *
+   * @param cells The board to transform, with one byte per cell in row-major order.
+   * @param grid Set to the board in the coordinates and digits of the board that was reduced.
+   **/
+  void backward(std::string const& cells, Grid& grid) const;
+
+private:
+  /**
+   * @brief Order some lines by their signatures: the groups of root lines (bands or stacks) by
+   *        the sum of their signatures, and then the lines within each group.
+   **/
+  void arrange(std::vector<std::uint64_t> const& signatures, std::vector<std::uint16_t>& order);
+  /**
+   * @brief Lay the board out with the given order of rows and columns (of the board, or of its
+   *        transpose), number the digits, and keep the result if it is smaller than the best one
+   *        so far.
+   **/
+  void lay_out(std::uint8_t const* cells, bool transposed, bool first);
+
+  std::size_t dim, root;
+  /**
+   * @brief The cell of the board that every cell of the canonical form comes from, and the
+   *        canonical digit of every digit of the board, and the reverse.
+   **/
+  std::vector<std::uint16_t> source;
+  std::uint8_t relabel[Grid::MAX_N + 1], restore[Grid::MAX_N + 1];
+  std::string form;
+
+  /**
+   * @brief Scratch space, which is kept between calls to avoid allocating.
+   **/
+  std::vector<std::uint64_t> row_signatures, column_signatures, group_signatures;
+  std::vector<std::uint16_t> row_order, column_order, group_order, digits, row_clues, column_clues;
+  std::vector<std::uint16_t> clues;
+  std::vector<std::uint16_t> candidate_source;
+  std::string candidate;
+  std::uint8_t candidate_relabel[Grid::MAX_N + 1];
+  std::uint16_t offsets[Grid::MAX_N];
+};
+
+#endif // CANONICAL_H
@@ -0,0 +1,321 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "checker.h"
+#include "bitboard.h"
+#include "bits.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+constexpr int SolutionChecker::PASSED;
+constexpr int SolutionChecker::CHANGED_GIVEN;
+
+namespace
+{
+  //the first row of a band, the last column of every row, and the last column of every block
+  std::uint32_t const ROW = 0x1FF;
+  std::uint32_t const ROW_ENDS = 1 << 8 | 1 << 17 | 1 << 26;
+  std::uint32_t const BLOCK_ENDS = 1 << 2 | 1 << 5 | 1 << 8;
+
+#if defined(__SSE2__)
+  //each band is read with two loads, the second one starting 11 cells in, so that the last load
+  //ends on the last cell of the board
+  std::size_t const STARTS[6] = {0, 11, 27, 38, 54, 65};
+
+  inline __m128i load(std::uint8_t const* cells, std::size_t part)
+  {
+    return _mm_loadu_si128(reinterpret_cast<__m128i const*>(cells + STARTS[part]));
+  }
+#endif
+
+  /**
+   * @brief Whether a board has the same digit as its puzzle in every cell the puzzle gives
+   **/
+  bool keeps_givens(std::uint8_t const* puzzle, std::uint8_t const* solution)
+  {
+#if defined(__SSE2__)
+    __m128i const unknown = _mm_setzero_si128();
+    int kept = 0xFFFF;
+
+    for (std::size_t part = 0; part < 6; part++)
+    {
+      __m128i given = load(puzzle, part);
+      __m128i same = _mm_or_si128(_mm_cmpeq_epi8(given, unknown),
+                                  _mm_cmpeq_epi8(given, load(solution, part)));
+      kept &= _mm_movemask_epi8(same);
+    }
+
+    return kept == 0xFFFF;
+#else
+    std::uint8_t changed = 0;
+
+    for (std::size_t cell = 0; cell < 81; cell++)
+    {
+      changed |= std::uint8_t(puzzle[cell] != 0 && puzzle[cell] != solution[cell]);
+    }
+
+    return changed == 0;
+#endif
+  }
+
+  /**
+   * @brief Gather the cells holding each digit into a bitboard. Cells that hold no digit between 1
+   *        and 9 are in none of them.
+   **/
+  void split(std::uint8_t const* cells, Cells81 digits[9])
+  {
+#if defined(__SSE2__)
+    __m128i parts[6];
+
+    for (std::size_t part = 0; part < 6; part++)
+    {
+      parts[part] = load(cells, part);
+    }
+
+    for (int d = 0; d < 9; d++)
+    {
+      __m128i digit = _mm_set1_epi8(char(d + 1));
+      std::uint32_t bands[3];
+
+      for (std::size_t b = 0; b < 3; b++)
+      {
+        std::uint32_t head = _mm_movemask_epi8(_mm_cmpeq_epi8(parts[2 * b], digit));
+        std::uint32_t tail = _mm_movemask_epi8(_mm_cmpeq_epi8(parts[2 * b + 1], digit));
+        bands[b] = head | tail << 11;
+      }
+
+      digits[d] = Cells81(bands[0], bands[1], bands[2]);
+    }
+#else
+    std::uint32_t bands[9][3] = {};
+
+    for (std::size_t cell = 0; cell < 81; cell++)
+    {
+      int a = cells[cell];
+
+      if (a >= 1 && a <= 9)
+      {
+        bands[a - 1][cell / 27] |= std::uint32_t(1) << (cell % 27);
+      }
+    }
+
+    for (int d = 0; d < 9; d++)
+    {
+      digits[d] = Cells81(bands[d][0], bands[d][1], bands[d][2]);
+    }
+#endif
+  }
+
+  /**
+   * @brief The first unit of a 9*9 board that misses a digit, or PASSED
+   **/
+  int first_conflict(std::uint8_t const* cells)
+  {
+    Cells81 digits[9];
+    split(cells, digits);
+
+    //the units that hold every digit seen so far, marked on their last cell
+    Cells81 rows = Cells81::bands(ROW_ENDS);
+    Cells81 columns = Cells81::bands(ROW);
+    Cells81 blocks = Cells81::bands(BLOCK_ENDS);
+
+    for (int d = 0; d < 9; d++)
+    {
+      Cells81 where = digits[d];
+
+      //smear every row onto its last cell; bits that spill into the next row never reach its end
+      Cells81 seen = where | where.left<1>();
+      seen = seen | seen.left<2>();
+      rows &= seen | seen.left<4>() | where.left<8>();
+
+      //fold the rows of each band onto the first one, then all three bands onto each other
+      Cells81 band = (where | where.right<9>() | where.right<18>()) & Cells81::bands(ROW);
+      blocks &= band | band.left<1>() | band.left<2>();
+      columns &= band | band.rotate_bands<1>() | band.rotate_bands<2>();
+    }
+
+    Cells81 missing = Cells81::bands(ROW_ENDS).minus(rows) | Cells81::bands(ROW).minus(columns)
+      | Cells81::bands(BLOCK_ENDS).minus(blocks);
+
+    if (missing.empty())
+    {
+      return SolutionChecker::PASSED;
+    }
+
+    //one bit per unit, in the order of geometry.h
+    std::uint32_t failed = (~columns.band(0) & ROW) << 9;
+
+    for (std::size_t b = 0; b < 3; b++)
+    {
+      for (std::size_t i = 0; i < 3; i++)
+      {
+        failed |= std::uint32_t((rows.band(b) >> (9 * i + 8) & 1) == 0) << (3 * b + i);
+        failed |= std::uint32_t((blocks.band(b) >> (3 * i + 2) & 1) == 0) << (18 + 3 * b + i);
+      }
+    }
+
+    return Bits::lowest_color(failed) - 1;
+  }
+
+  /**
+   * @brief The first unit of a board of any size that misses a digit, or PASSED
+   *
+   * @tparam Mask The type of the color masks, which must have at least n bits.
+   **/
+  template <class Mask>
+  int first_conflict(Grid const& grid)
+  {
+    std::size_t const n = grid.n();
+    std::size_t root = 0;
+
+    while (root * root < n)
+    {
+      root++;
+    }
+
+    std::uint8_t const* cells = grid.cells();
+    Mask const all = Bits::all_colors<Mask>(n);
+
+    for (std::size_t u = 0; u < 3 * n; u++)
+    {
+      Mask mask = 0;
+
+      for (std::size_t i = 0; i < n; i++)
+      {
+        std::size_t cell;
+
+        if (u < n)
+        {
+          cell = u * n + i;
+        }
+        else if (u < 2 * n)
+        {
+          cell = i * n + (u - n);
+        }
+        else
+        {
+          std::size_t block = u - 2 * n;
+          cell = ((block / root) * root + i / root) * n + (block % root) * root + i % root;
+        }
+
+        int a = cells[cell];
+
+        //ignore incomplete elements, which leave a digit out of the unit
+        if (a >= 1 && std::size_t(a) <= n)
+        {
+          mask |= Bits::color_bit<Mask>(a);
+        }
+      }
+
+      if (mask != all)
+      {
+        return int(u);
+      }
+    }
+
+    return SolutionChecker::PASSED;
+  }
+}
+
+int SolutionChecker::check(std::uint8_t const* puzzle, std::uint8_t const* solution)
+{
+  if (puzzle != nullptr && !keeps_givens(puzzle, solution))
+  {
+    return CHANGED_GIVEN;
+  }
+
+  return first_conflict(solution);
+}
+
+std::size_t SolutionChecker::check(std::uint8_t const* puzzles, std::uint8_t const* solutions,
+                                   std::size_t count, std::uint64_t* passed,
+                                   std::int8_t* conflicts)
+{
+  std::size_t good = 0;
+
+  for (std::size_t i = 0; i < count; i += 64)
+  {
+    std::size_t end = (count - i < 64) ? count : i + 64;
+    std::uint64_t word = 0;
+
+    for (std::size_t j = i; j < end; j++)
+    {
+      int verdict = check(puzzles ? puzzles + 81 * j : nullptr, solutions + 81 * j);
+
+      word |= std::uint64_t(verdict == PASSED) << (j - i);
+
+      if (conflicts != nullptr)
+      {
+        conflicts[j] = std::int8_t(verdict);
+      }
+    }
+
+    passed[i / 64] = word;
+    good += Bits::count(word);
+  }
+
+  return good;
+}
+
+int SolutionChecker::check(Grid const& puzzle, Grid const& solution)
+{
+  if (puzzle.n() != solution.n())
+  {
+    return CHANGED_GIVEN;
+  }
+
+  if (solution.n() == 9)
+  {
+    return check(puzzle.cells(), solution.cells());
+  }
+
+  std::uint8_t const* givens = puzzle.cells();
+  std::uint8_t const* cells = solution.cells();
+
+  for (std::size_t cell = 0; cell < solution.n() * solution.n(); cell++)
+  {
+    if (givens[cell] != 0 && givens[cell] != cells[cell])
+    {
+      return CHANGED_GIVEN;
+    }
+  }
+
+  if (solution.n() <= 64)
+  {
+    return first_conflict<std::uint_fast64_t>(solution);
+  }
+  else if (solution.n() <= 128)
+  {
+    return first_conflict<Mask128>(solution);
+  }
+  else
+  {
+    return first_conflict<Mask192>(solution);
+  }
+}
+
+bool SolutionChecker::vectorized()
+{
+#if defined(__SSE2__)
+  return true;
+#else
+  return false;
+#endif
+}
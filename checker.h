@@ -0,0 +1,97 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHECKER_H
+#define CHECKER_H
+
+#include <cstdint>
+#include <cstddef>
+
+#include "grid.h"
+
+/**
+ * @brief Checks completed boards, such as the ones submitted by players, against their puzzles
+ *
+ * A board passes if it keeps every given of its puzzle and every unit of it holds the digits 1-n
+ * exactly once. When it does not, the checker tells which unit it failed on first, with the units
+ * numbered as in geometry.h: the rows first (0 to n-1), then the columns (n to 2n-1), then the
+ * blocks (2n to 3n-1).
+ *
+ * 9*9 boards are checked a digit at a time: the cells holding a digit are gathered into a bitboard
+ * (see Cells81) with one 16-byte comparison per half band, and the rows, the columns and the blocks
+ * of all three bands are checked for that digit with a few shifts. A unit of nine cells holds every
+ * digit exactly once if and only if it holds every digit, so there is no need to count anything.
+ * This takes no branches until the verdict, which is what lets bursts of submissions be checked at
+ * millions of boards per second. Other sizes go through a plain loop over the units.
+ **/
+class SolutionChecker
+{
+public:
+  /**
+   * @brief The verdict of a board that passed
+   **/
+  static constexpr int PASSED = -1;
+  /**
+   * @brief The verdict of a board that does not keep the givens of its puzzle
+   **/
+  static constexpr int CHANGED_GIVEN = -2;
+
+  /**
+   * @brief Check one 9*9 board
+   *
+   * @param puzzle The 81 cells of the puzzle, in row-major order, with 0 for the unknown cells. May
+   *               be null, in which case the givens are not checked.
+   * @param solution The 81 cells of the board to check.
+   * @return int PASSED, CHANGED_GIVEN, or the first unit that does not hold every digit.
+   **/
+  static int check(std::uint8_t const* puzzle, std::uint8_t const* solution);
+
+  /**
+   * @brief Check many 9*9 boards at once
+   *
+   * @param puzzles The puzzles, 81 cells each, one after the other. May be null, in which case the
+   *                givens are not checked.
+   * @param solutions The boards to check, 81 cells each, in the same order as their puzzles.
+   * @param count The number of boards.
+   * @param passed A bitmap with room for (count + 63) / 64 words. Bit i % 64 of word i / 64 is set
+   *               if board i passed, and cleared otherwise.
+   * @param conflicts If not null, gets the verdict of every board (see above).
+   * @return std::size_t The number of boards that passed.
+   **/
+  static std::size_t check(std::uint8_t const* puzzles, std::uint8_t const* solutions,
+                           std::size_t count, std::uint64_t* passed,
+                           std::int8_t* conflicts = nullptr);
+
+  /**
+   * @brief Check one board of any size
+   *
+   * @param puzzle The puzzle. A board of another size than the puzzle never keeps its givens.
+   * @param solution The board to check.
+   * @return int PASSED, CHANGED_GIVEN, or the first unit that does not hold every digit.
+   **/
+  static int check(Grid const& puzzle, Grid const& solution);
+
+  /**
+   * @brief Whether 9*9 boards are checked in SIMD registers, or with the scalar fallback
+   *
+   * @return bool Whether the checker was built with SSE2.
+   **/
+  static bool vectorized();
+};
+
+#endif // CHECKER_H
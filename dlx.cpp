@@ -0,0 +1,313 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "dlx.h"
+#include "bits.h"
+#include "validator.h"
+
+#include <algorithm>
+#include <cmath>
+
+DancingLinks::DancingLinks(Grid const& grid, SolveStats* stats, Watchdog* watchdog)
+  : dim(grid.n()), stats(stats), watchdog(watchdog)
+{
+  const std::size_t n = this->dim, cells = n * n;
+  const std::uint32_t columns = std::uint32_t(4 * cells);
+
+  //the root and the column headers form the first row of circular lists
+  this->nodes.resize(columns + 1);
+  this->sizes.assign(columns + 1, 0);
+
+  for (std::uint32_t c = 0; c <= columns; c++)
+  {
+    Node& node = this->nodes[c];
+    node.left = (c == 0) ? columns : c - 1;
+    node.right = (c == columns) ? 0 : c + 1;
+    node.up = node.down = node.column = c;
+    node.row = 0;
+  }
+
+  this->stack.reserve(cells);
+
+  //the colors are kept in the narrowest mask that holds them all
+  if (n <= 64)
+  {
+    this->add_rows<std::uint_fast64_t>(grid);
+  }
+  else if (n <= 128)
+  {
+    this->add_rows<Mask128>(grid);
+  }
+  else
+  {
+    this->add_rows<Mask192>(grid);
+  }
+}
+
+template <class Mask>
+void DancingLinks::add_rows(Grid const& grid)
+{
+  const std::size_t n = this->dim, cells = n * n, n_root = std::size_t(sqrt(n) + 0.5);
+  std::vector<Mask> candidates(cells);
+  std::size_t rows = 0;
+
+  //find the colors of every cell first, so that the nodes can be allocated once, 4 per row
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      int a = grid.get(x, y);
+      Mask& colors = candidates[y * n + x];
+
+      colors = (a == -1) ? Validator::good_colors<Mask>(grid, x, y) : Bits::color_bit<Mask>(a);
+      rows += Bits::count(colors);
+
+      if (a == -1 && this->stats != nullptr)
+      {
+        this->stats->validator_calls++;
+      }
+    }
+  }
+
+  this->nodes.reserve(this->nodes.size() + 4 * rows);
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      std::size_t block = (y / n_root) * n_root + (x / n_root);
+
+      for (Mask colors = candidates[y * n + x]; colors != 0; colors = Bits::drop_lowest(colors))
+      {
+        std::size_t i = Bits::lowest_color(colors) - 1;
+
+        //column headers are numbered from 1, since node 0 is the root
+        std::uint32_t const row_columns[4] = {
+          std::uint32_t(1 + y * n + x),
+          std::uint32_t(1 + cells + y * n + i),
+          std::uint32_t(1 + 2 * cells + x * n + i),
+          std::uint32_t(1 + 3 * cells + block * n + i)
+        };
+
+        this->add_row(std::uint32_t((y * n + x) * n + i), row_columns);
+      }
+    }
+  }
+}
+
+void DancingLinks::add_row(std::uint32_t row, std::uint32_t const (&columns)[4])
+{
+  std::uint32_t first = std::uint32_t(this->nodes.size());
+
+  for (std::uint32_t k = 0; k < 4; k++)
+  {
+    std::uint32_t index = first + k, column = columns[k];
+    Node node;
+
+    //link the node into its row
+    node.left = first + (k + 3) % 4;
+    node.right = first + (k + 1) % 4;
+
+    //link the node into the bottom of its column
+    node.column = column;
+    node.row = row;
+    node.up = this->nodes[column].up;
+    node.down = column;
+
+    this->nodes.push_back(node);
+    this->nodes[this->nodes[index].up].down = index;
+    this->nodes[column].up = index;
+    this->sizes[column]++;
+  }
+}
+
+void DancingLinks::cover(std::uint32_t column)
+{
+  Node& header = this->nodes[column];
+  this->nodes[header.right].left = header.left;
+  this->nodes[header.left].right = header.right;
+
+  for (std::uint32_t i = header.down; i != column; i = this->nodes[i].down)
+  {
+    for (std::uint32_t j = this->nodes[i].right; j != i; j = this->nodes[j].right)
+    {
+      Node& node = this->nodes[j];
+      this->nodes[node.down].up = node.up;
+      this->nodes[node.up].down = node.down;
+      this->sizes[node.column]--;
+    }
+  }
+}
+
+void DancingLinks::uncover(std::uint32_t column)
+{
+  Node& header = this->nodes[column];
+
+  for (std::uint32_t i = header.up; i != column; i = this->nodes[i].up)
+  {
+    for (std::uint32_t j = this->nodes[i].left; j != i; j = this->nodes[j].left)
+    {
+      Node& node = this->nodes[j];
+      this->sizes[node.column]++;
+      this->nodes[node.down].up = j;
+      this->nodes[node.up].down = j;
+    }
+  }
+
+  this->nodes[header.right].left = column;
+  this->nodes[header.left].right = column;
+}
+
+void DancingLinks::search(std::size_t limit, std::size_t& found)
+{
+  bool descend = true;
+
+  this->stack.clear();
+
+  while (true)
+  {
+    if (this->watchdog != nullptr && this->watchdog->expired())
+    {
+      return;
+    }
+
+    if (descend && this->stats != nullptr)
+    {
+      this->stats->nodes++;
+    }
+
+    if (descend)
+    {
+      //every column is covered, so the rows we picked are a solution
+      if (this->nodes[0].right == 0)
+      {
+        if (found == 0)
+        {
+          this->solution.clear();
+
+          for (std::size_t k = 0; k < this->stack.size(); k++)
+          {
+            this->solution.push_back(this->nodes[this->stack[k].node].row);
+          }
+        }
+
+        found++;
+      }
+      else
+      {
+        //pick the column with the fewest rows left, since it has the fewest ways to be covered
+        std::uint32_t column = this->nodes[0].right;
+
+        for (std::uint32_t c = this->nodes[column].right; c != 0; c = this->nodes[c].right)
+        {
+          if (this->sizes[c] < this->sizes[column])
+          {
+            column = c;
+          }
+        }
+
+        //a column that can't be covered at all is a dead end, and is left alone
+        if (this->sizes[column] != 0)
+        {
+          Frame frame;
+          frame.column = column;
+          frame.node = column;
+          this->stack.push_back(frame);
+          this->cover(column);
+
+          if (this->stats != nullptr)
+          {
+            this->stats->max_depth = std::max<std::uint64_t>(this->stats->max_depth,
+                                                             this->stack.size());
+          }
+        }
+        else if (this->stats != nullptr)
+        {
+          this->stats->backtracks++;
+        }
+      }
+    }
+
+    //move on to the next row of the deepest column that has any left, backing out of the others
+    descend = false;
+
+    while (!this->stack.empty() && !descend)
+    {
+      Frame& frame = this->stack.back();
+
+      //put back the columns taken out by the row we picked last time
+      if (frame.node != frame.column)
+      {
+        for (std::uint32_t j = this->nodes[frame.node].left; j != frame.node;
+             j = this->nodes[j].left)
+        {
+          this->uncover(this->nodes[j].column);
+        }
+      }
+
+      frame.node = this->nodes[frame.node].down;
+
+      if (frame.node != frame.column && found < limit)
+      {
+        //pick this row, which takes every other column it covers out of the running
+        for (std::uint32_t j = this->nodes[frame.node].right; j != frame.node;
+             j = this->nodes[j].right)
+        {
+          this->cover(this->nodes[j].column);
+        }
+
+        descend = true;
+      }
+      else
+      {
+        this->uncover(frame.column);
+        this->stack.pop_back();
+      }
+    }
+
+    if (!descend)
+    {
+      //the whole tree has been explored
+      return;
+    }
+  }
+}
+
+bool DancingLinks::solve()
+{
+  return this->count(1) == 1;
+}
+
+std::size_t DancingLinks::count(std::size_t limit)
+{
+  std::size_t found = 0;
+  this->search(limit, found);
+  return found;
+}
+
+void DancingLinks::store(Grid& grid) const
+{
+  const std::size_t n = this->dim;
+
+  for (std::size_t k = 0; k < this->solution.size(); k++)
+  {
+    std::uint32_t row = this->solution[k];
+    std::size_t cell = row / n;
+    grid.set(cell % n, cell / n, int(row % n) + 1);
+  }
+}
@@ -0,0 +1,151 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DLX_H
+#define DLX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "grid.h"
+#include "stats.h"
+#include "watchdog.h"
+
+/**
+ * @brief A Sudoku puzzle expressed as an exact cover problem, solved with Knuth's Algorithm X
+ *
+ * Every way of coloring a cell is a row of the exact cover matrix, and every row covers four
+ * columns: the cell itself, the color in the cell's row, the color in the cell's column, and the
+ * color in the cell's block. A solution is a set of rows that covers every column exactly once.
+ *
+ * The sparse matrix is stored as dancing links: circular doubly-linked lists running through the
+ * rows and the columns. All of the nodes live in a single contiguous array and refer to each other
+ * by index, so the matrix is built with a handful of allocations and is friendly to the cache.
+ **/
+class DancingLinks
+{
+public:
+  /**
+   * @brief Build the exact cover matrix for a puzzle
+   *
+   * Only the colors that do not clash with the known cells are added as rows, and a known cell
+   * only gets the row for its own color.
+   *
+   * @param grid The Sudoku board. It must not contain any repeated colors in a unit.
+   * @param stats Where to count what building the matrix and searching it go through, if anywhere
+   *              (see SolveStats).
+   * @param watchdog The limits of the search, if any (see Watchdog).
+   **/
+  DancingLinks(Grid const& grid, SolveStats* stats = nullptr, Watchdog* watchdog = nullptr);
+
+  /**
+   * @brief Search for a solution. If one is found, it can be retrieved with store().
+   *
+   * @return bool Whether the puzzle has a solution.
+   **/
+  bool solve();
+  /**
+   * @brief Count the solutions of the puzzle, stopping early once a limit is reached. If there
+   *        are any, the first one can be retrieved with store().
+   *
+   * @param limit The number of solutions after which the search gives up.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  std::size_t count(std::size_t limit);
+
+  /**
+   * @brief Copy the first solution found into a grid
+   *
+   * @param grid The grid to overwrite. It must have the same size as the puzzle.
+   **/
+  void store(Grid& grid) const;
+
+private:
+  /**
+   * @brief A 1 in the sparse matrix, or the header of a column
+   **/
+  struct Node
+  {
+    std::uint32_t left, right, up, down, column, row;
+  };
+
+  /**
+   * @brief A column being covered by the search, and the node of the row picked to cover it (or
+   *        the column header, before any row has been picked)
+   **/
+  struct Frame
+  {
+    std::uint32_t column, node;
+  };
+
+  /**
+   * @brief Add a row to the matrix for every color that every cell of a board may use
+   *
+   * @tparam Mask The type of the color masks, which must have at least n bits.
+   **/
+  template <class Mask>
+  void add_rows(Grid const& grid);
+  /**
+   * @brief Add a row covering four columns to the matrix
+   **/
+  void add_row(std::uint32_t row, std::uint32_t const (&columns)[4]);
+  /**
+   * @brief Remove a column, and every row that covers it, from the matrix
+   **/
+  void cover(std::uint32_t column);
+  /**
+   * @brief Put back a column removed by cover() (this must happen in the reverse order)
+   **/
+  void uncover(std::uint32_t column);
+  /**
+   * @brief Algorithm X: cover the column with the fewest rows, try each of its rows in turn, and
+   *        repeat. The search keeps an explicit stack instead of recursing, so its depth is only
+   *        limited by the number of cells.
+   *
+   * @param limit The number of solutions after which the search gives up.
+   * @param found The number of solutions found so far.
+   **/
+  void search(std::size_t limit, std::size_t& found);
+
+  /**
+   * @brief The side length of the puzzle.
+   **/
+  std::size_t dim;
+  /**
+   * @brief The nodes of the matrix. Node 0 is the root, and the column headers come next.
+   **/
+  std::vector<Node> nodes;
+  /**
+   * @brief The number of rows still covering each column.
+   **/
+  std::vector<std::uint32_t> sizes;
+  /**
+   * @brief The columns covered on the way down the search tree. There is at most one per cell.
+   **/
+  std::vector<Frame> stack;
+  /**
+   * @brief The rows picked in the first solution. Row r stands for the color r % n + 1 in the
+   *        cell r / n.
+   **/
+  std::vector<std::uint32_t> solution;
+  SolveStats* stats;
+  Watchdog* watchdog;
+};
+
+#endif // DLX_H
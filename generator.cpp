@@ -0,0 +1,301 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "generator.h"
+#include "serializer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+namespace
+{
+  /**
+   * @brief The search nodes a filling of the diagonal gets per cell of the board before it is
+   *        given up on. Most fillings take well under one node per cell.
+   **/
+  std::uint64_t const FILL_NODES_PER_CELL = 16;
+
+  /**
+   * @brief Scramble the bits of a number (the finalizer of SplitMix64), so that nearby seeds give
+   *        unrelated sequences
+   **/
+  std::uint64_t mix(std::uint64_t x)
+  {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  /**
+   * @brief A random number below some bound. Unlike the distributions of the standard library,
+   *        this gives the same numbers (and so the same puzzles) with every implementation.
+   **/
+  std::size_t below(std::mt19937_64& random, std::size_t bound)
+  {
+    return random() % bound;
+  }
+
+  template <class T>
+  void shuffle(std::mt19937_64& random, std::vector<T>& items)
+  {
+    for (std::size_t i = items.size(); i > 1; i--)
+    {
+      std::swap(items[i - 1], items[below(random, i)]);
+    }
+  }
+
+  /**
+   * @brief A random order of the rows (or columns) of a board that keeps every band (or stack)
+   *        together, so that the blocks stay blocks
+   **/
+  std::vector<std::size_t> shuffle_lines(std::mt19937_64& random, std::size_t root)
+  {
+    std::vector<std::size_t> bands(root), lines(root), order;
+    std::iota(bands.begin(), bands.end(), 0);
+    shuffle(random, bands);
+
+    for (std::size_t band : bands)
+    {
+      std::iota(lines.begin(), lines.end(), band * root);
+      shuffle(random, lines);
+      order.insert(order.end(), lines.begin(), lines.end());
+    }
+
+    return order;
+  }
+
+  /**
+   * @brief The cell that has to be taken away together with some cell to keep the clues symmetric
+   **/
+  std::size_t partner(Symmetry symmetry, std::size_t n, std::size_t cell)
+  {
+    switch (symmetry)
+    {
+      case Symmetry::ROTATIONAL: { return n * n - 1 - cell; }
+      case Symmetry::MIRROR: { return (cell / n) * n + (n - 1 - cell % n); }
+      default: { return cell; }
+    }
+  }
+}
+
+Generator::Options::Options()
+  : n(9), clues(0), symmetry(Symmetry::NONE), seed(0), attempts(100), budget(1000)
+{
+}
+
+Generator::Summary::Summary() : total(0), over(0)
+{
+}
+
+Generator::Generator(Options const& options, std::size_t threads)
+  : options(options), pool(threads)
+{
+  for (std::size_t i = 0; i < this->pool.size(); i++)
+  {
+    this->kernels.push_back(Kernel::create(options.n));
+  }
+}
+
+std::size_t Generator::threads() const
+{
+  return this->pool.size();
+}
+
+bool Generator::generate(std::uint64_t index, Grid& puzzle)
+{
+  return this->generate(*this->kernels[0], index, puzzle);
+}
+
+Generator::Summary Generator::generate(std::size_t count, std::ostream& out)
+{
+  Summary summary;
+  const Layout layout = (this->options.n <= 25) ? Layout::COMPACT : Layout::SPACED;
+
+  //enough puzzles in flight to keep every worker busy, but few enough to write them out as we go
+  const std::size_t window = 64 * this->threads();
+  std::vector<std::string> texts(window);
+  std::vector<char> over(window);
+
+  for (std::size_t first = 0; first < count; first += window)
+  {
+    std::size_t size = std::min(window, count - first);
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+      this->pool.submit([this, first, i, layout, &texts, &over](std::size_t worker)
+      {
+        Grid puzzle(this->options.n);
+        over[i] = !this->generate(*this->kernels[worker], first + i, puzzle);
+
+        std::string& text = texts[i];
+        text.resize(Serializer::size(puzzle, layout));
+        Serializer::write(puzzle, layout, &text[0], text.size());
+        text += (layout == Layout::COMPACT) ? "\n" : "\n\n";
+      });
+    }
+
+    this->pool.wait();
+
+    for (std::size_t i = 0; i < size; i++)
+    {
+      out << texts[i];
+      summary.over += over[i];
+      summary.total++;
+    }
+  }
+
+  return summary;
+}
+
+bool Generator::generate(Kernel& kernel, std::uint64_t index, Grid& puzzle) const
+{
+  std::mt19937_64 random(mix(this->options.seed ^ mix(index)));
+  Grid grid(this->options.n);
+  std::size_t best = std::size_t(-1);
+
+  for (std::size_t attempt = 0; attempt < std::max<std::size_t>(this->options.attempts, 1);
+       attempt++)
+  {
+    this->fill(kernel, random, grid);
+    std::size_t clues = this->dig(kernel, random, grid);
+
+    if (clues < best)
+    {
+      best = clues;
+      puzzle = grid;
+    }
+
+    if (best <= this->options.clues || this->options.clues == 0)
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void Generator::fill(Kernel& kernel, std::mt19937_64& random, Grid& grid) const
+{
+  const std::size_t n = this->options.n;
+  std::size_t root = 1;
+
+  while (root * root < n)
+  {
+    root++;
+  }
+
+  std::vector<int> values(n);
+  std::iota(values.begin(), values.end(), 1);
+
+  SolveLimits limits;
+  limits.max_nodes = FILL_NODES_PER_CELL * n * n;
+  bool filled = false;
+
+  while (!filled)
+  {
+    grid.reset(n);
+
+    //the blocks on the diagonal do not share any units, so any values will do
+    for (std::size_t b = 0; b < root; b++)
+    {
+      shuffle(random, values);
+
+      for (std::size_t i = 0; i < n; i++)
+      {
+        grid.set(b * root + i % root, b * root + i / root, values[i]);
+      }
+    }
+
+    //a filling that is unsolvable, or that stalls the solve, is thrown away for a new one
+    Watchdog watchdog(limits);
+    kernel.guard(&watchdog);
+    filled = kernel.solve_bitboard(grid);
+    kernel.guard(nullptr);
+  }
+
+  //the solver always fills in the rest the same way, so shuffle the solution as a whole
+  std::vector<std::size_t> rows = shuffle_lines(random, root);
+  std::vector<std::size_t> columns = shuffle_lines(random, root);
+  bool transpose = (below(random, 2) == 1);
+  shuffle(random, values);
+
+  Grid solution(grid);
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      std::size_t from_x = columns[x], from_y = rows[y];
+
+      if (transpose)
+      {
+        std::swap(from_x, from_y);
+      }
+
+      grid.set(x, y, values[solution.get(from_x, from_y) - 1]);
+    }
+  }
+}
+
+std::size_t Generator::dig(Kernel& kernel, std::mt19937_64& random, Grid& grid) const
+{
+  const std::size_t n = this->options.n;
+  std::size_t clues = n * n;
+  std::vector<std::size_t> cells;
+
+  //one cell for every set of cells that come and go together
+  for (std::size_t cell = 0; cell < n * n; cell++)
+  {
+    if (partner(this->options.symmetry, n, cell) >= cell)
+    {
+      cells.push_back(cell);
+    }
+  }
+
+  shuffle(random, cells);
+
+  for (std::size_t cell : cells)
+  {
+    std::size_t other = partner(this->options.symmetry, n, cell);
+    std::size_t size = (other == cell) ? 1 : 2;
+
+    //never go below the target
+    if (clues < this->options.clues + size)
+    {
+      continue;
+    }
+
+    int a = grid.get(cell % n, cell / n), b = grid.get(other % n, other / n);
+    grid.set(cell % n, cell / n, -1);
+    grid.set(other % n, other / n, -1);
+
+    if (kernel.count(grid, 2, nullptr, 0, this->options.budget) == 1)
+    {
+      clues -= size;
+    }
+    else
+    {
+      grid.set(cell % n, cell / n, a);
+      grid.set(other % n, other / n, b);
+    }
+  }
+
+  return clues;
+}
@@ -0,0 +1,181 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <random>
+#include <vector>
+
+#include "grid.h"
+#include "kernel.h"
+#include "thread_pool.h"
+
+/**
+ * @brief The patterns that the clues of a generated puzzle can follow
+ **/
+enum class Symmetry
+{
+  /**
+   * @brief The clues are anywhere.
+   **/
+  NONE,
+  /**
+   * @brief The clues look the same after turning the board by 180 degrees.
+   **/
+  ROTATIONAL,
+  /**
+   * @brief The clues look the same after flipping the board from left to right.
+   **/
+  MIRROR
+};
+
+/**
+ * @brief Generates puzzles that have exactly one solution, on a pool of threads
+ *
+ * A puzzle starts out as a random full grid: the blocks on the main diagonal, which do not share
+ * any units, are filled with random permutations, the rest of the board is solved with the kernel
+ * for its size (see Kernel), and the solution is shuffled with transformations that keep it valid
+ * (relabeling the values, swapping rows within a band, swapping bands, the same for columns and
+ * stacks, and transposing). Some fillings of the diagonal make the solve stall for a long time,
+ * so it gets a budget of search nodes, and the diagonal is filled again whenever it runs out.
+ * Then the clues are taken away in a random order, a cell at a time (or a symmetric pair of cells
+ * at a time), and any removal that lets the puzzle have a second solution is undone, until the
+ * puzzle is down to the requested number of clues or no clue can go. If the target is not met,
+ * the generator starts over from a new full grid, a few times.
+ *
+ * Each uniqueness check is a count of up to two solutions (see Kernel::count()) with a budget of
+ * search nodes. 9*9 checks hardly ever come near it, but on sparse 25*25 boards a few checks would
+ * take minutes; the clue is kept instead, so the puzzle ends up with a few more clues than it
+ * could have, but it still has a unique solution.
+ *
+ * Every puzzle draws its random numbers from its own generator, seeded from the seed and the
+ * number of the puzzle, so the same seed gives the same puzzles no matter how many threads there
+ * are.
+ **/
+class Generator
+{
+public:
+  /**
+   * @brief The side length of the biggest boards the generator makes. Past it, filling in a grid
+   *        and checking every clue for uniqueness takes minutes to hours per puzzle.
+   **/
+  static const std::size_t MAX_N = 36;
+
+  /**
+   * @brief What kind of puzzles to generate
+   **/
+  struct Options
+  {
+    Options();
+
+    /**
+     * @brief The side length of the boards, which must be a perfect square no bigger than MAX_N.
+     **/
+    std::size_t n;
+    /**
+     * @brief The number of clues to aim for, or 0 for as few as possible.
+     **/
+    std::size_t clues;
+    Symmetry symmetry;
+    std::uint64_t seed;
+    /**
+     * @brief The number of full grids to try for a puzzle before settling for more clues.
+     **/
+    std::size_t attempts;
+    /**
+     * @brief The number of search nodes a uniqueness check may visit before the clue it is
+     *        checking is kept anyway, so that a big board does not get stuck on one hard check.
+     **/
+    std::size_t budget;
+  };
+
+  /**
+   * @brief How the puzzles of a run turned out
+   **/
+  struct Summary
+  {
+    Summary();
+
+    /**
+     * @brief The puzzles generated, and those that ended up with more clues than requested.
+     **/
+    std::size_t total, over;
+  };
+
+  /**
+   * @brief Start the workers
+   *
+   * @param options What kind of puzzles to generate.
+   * @param threads The number of workers, or 0 for one per hardware thread.
+   **/
+  explicit Generator(Options const& options, std::size_t threads = 0);
+
+  /**
+   * @brief The number of workers
+   **/
+  std::size_t threads() const;
+
+  /**
+   * @brief Generate a single puzzle on the calling thread
+   *
+   * @param index The number of the puzzle, which picks its random numbers.
+   * @param puzzle Set to the puzzle, which has exactly one solution.
+   * @return bool Whether the puzzle has the requested number of clues (it may have more).
+   **/
+  bool generate(std::uint64_t index, Grid& puzzle);
+  /**
+   * @brief Generate puzzles 0 to count-1 on the pool, and write them out in order: one line each
+   *        in the format read by Sudoku::read_puzzle_from_line() for boards up to 25*25, or as
+   *        grids separated by blank lines for bigger ones
+   *
+   * @param count The number of puzzles.
+   * @param out The stream of puzzles.
+   * @return Generator::Summary How many puzzles were generated.
+   **/
+  Summary generate(std::size_t count, std::ostream& out);
+
+private:
+  /**
+   * @brief Fill a grid with a random solution
+   **/
+  void fill(Kernel& kernel, std::mt19937_64& random, Grid& grid) const;
+  /**
+   * @brief Take as many clues as possible out of a full grid, keeping its solution unique
+   *
+   * @return std::size_t The number of clues left.
+   **/
+  std::size_t dig(Kernel& kernel, std::mt19937_64& random, Grid& grid) const;
+  /**
+   * @brief Generate a puzzle with the kernel of some worker
+   **/
+  bool generate(Kernel& kernel, std::uint64_t index, Grid& puzzle) const;
+
+  Options options;
+  ThreadPool pool;
+  /**
+   * @brief The solver of every worker.
+   **/
+  std::vector<std::unique_ptr<Kernel>> kernels;
+};
+
+#endif // GENERATOR_H
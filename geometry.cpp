@@ -0,0 +1,69 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "geometry.h"
+
+void GeometryTables::build(std::size_t root, std::uint16_t* blocks, std::uint16_t* units,
+                           std::uint16_t* peers)
+{
+  const std::size_t n = root * root;
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      std::size_t cell = y * n + x, block = (y / root) * root + (x / root);
+      std::size_t block_x = (x / root) * root, block_y = (y / root) * root;
+
+      blocks[cell] = std::uint16_t(block);
+
+      //the cell is the x-th cell of its row, the y-th cell of its column, and so on
+      units[y * n + x] = std::uint16_t(cell);
+      units[(n + x) * n + y] = std::uint16_t(cell);
+      units[(2 * n + block) * n + (y - block_y) * root + (x - block_x)] = std::uint16_t(cell);
+
+      //the rest of the row, the rest of the column, and then the rest of the block
+      for (std::size_t k = 0; k < n; k++)
+      {
+        if (k != x)
+        {
+          *peers++ = std::uint16_t(y * n + k);
+        }
+      }
+
+      for (std::size_t k = 0; k < n; k++)
+      {
+        if (k != y)
+        {
+          *peers++ = std::uint16_t(k * n + x);
+        }
+      }
+
+      for (std::size_t k_y = block_y; k_y < block_y + root; k_y++)
+      {
+        for (std::size_t k_x = block_x; k_x < block_x + root; k_x++)
+        {
+          if (k_x != x && k_y != y)
+          {
+            *peers++ = std::uint16_t(k_y * n + k_x);
+          }
+        }
+      }
+    }
+  }
+}
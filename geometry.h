@@ -0,0 +1,175 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "bits.h"
+
+/**
+ * @brief The shape of an n*n Sudoku board: which cells make up each unit, and which cells are
+ *        connected to each other
+ *
+ * Cells are numbered in row-major order. Units are numbered with the rows first (0 to n-1), then
+ * the columns (n to 2n-1), then the blocks (2n to 3n-1), and blocks are numbered in row-major order
+ * as well. The peers of a cell are the 3n-2*sqrt(n)-1 other cells that share a unit with it.
+ *
+ * The solvers are templates over a geometry class, which has to provide the same members as the
+ * classes below. FixedGeometry is used for the common board sizes: its side length and mask type
+ * are compile-time constants, so the compiler can unroll the unit loops and turn the divisions
+ * into multiplications. DynamicGeometry handles every other size at run time, with a 64-bit mask
+ * up to 64*64 and a multi-word Bitset above that.
+ **/
+class GeometryTables
+{
+public:
+  /**
+   * @brief Fill in the lookup tables for a board
+   *
+   * @param root The side length of a block (i.e., sqrt(n)).
+   * @param blocks The block of every cell. Must have room for n*n entries.
+   * @param units The cells of every unit. Must have room for 3n*n entries.
+   * @param peers The peers of every cell. Must have room for n*n*(3n-2*sqrt(n)-1) entries.
+   **/
+  static void build(std::size_t root, std::uint16_t* blocks, std::uint16_t* units,
+                    std::uint16_t* peers);
+};
+
+/**
+ * @brief The geometry of a board whose size is known at compile time
+ *
+ * @tparam ROOT The side length of a block (i.e., sqrt(n)).
+ * @tparam MASK The unsigned integer type used for color masks. It must have at least n bits.
+ **/
+template <std::size_t ROOT, class MASK>
+class FixedGeometry
+{
+public:
+  typedef MASK mask_type;
+
+  static constexpr std::size_t ROOT_SIZE = ROOT;
+  static constexpr std::size_t SIZE = ROOT * ROOT;
+  static constexpr std::size_t CELLS = SIZE * SIZE;
+  static constexpr std::size_t PEERS = 3 * SIZE - 2 * ROOT - 1;
+
+  static_assert(8 * sizeof(MASK) >= SIZE, "the mask type is too narrow for this board");
+
+  /**
+   * @brief Construct the geometry. The size parameter is ignored, and only exists so that the
+   *        constructor looks like the one of DynamicGeometry.
+   **/
+  FixedGeometry(std::size_t = SIZE)
+  {
+    GeometryTables::build(ROOT, this->block_table.data(), this->unit_table.data(),
+                          this->peer_table.data());
+  }
+
+  static constexpr std::size_t n() { return SIZE; }
+  static constexpr std::size_t root() { return ROOT; }
+  static constexpr std::size_t cells() { return CELLS; }
+  static constexpr std::size_t peer_count() { return PEERS; }
+  static mask_type all() { return Bits::all_colors<mask_type>(SIZE); }
+
+  static std::size_t row(std::size_t cell) { return cell / SIZE; }
+  static std::size_t column(std::size_t cell) { return cell % SIZE; }
+  std::size_t block(std::size_t cell) const { return this->block_table[cell]; }
+  std::uint16_t const* unit(std::size_t u) const { return &this->unit_table[u * SIZE]; }
+  std::uint16_t const* peers(std::size_t cell) const { return &this->peer_table[cell * PEERS]; }
+
+private:
+  std::array<std::uint16_t, CELLS> block_table;
+  std::array<std::uint16_t, 3 * CELLS> unit_table;
+  std::array<std::uint16_t, CELLS * PEERS> peer_table;
+};
+
+template <std::size_t ROOT, class MASK> constexpr std::size_t FixedGeometry<ROOT, MASK>::ROOT_SIZE;
+template <std::size_t ROOT, class MASK> constexpr std::size_t FixedGeometry<ROOT, MASK>::SIZE;
+template <std::size_t ROOT, class MASK> constexpr std::size_t FixedGeometry<ROOT, MASK>::CELLS;
+template <std::size_t ROOT, class MASK> constexpr std::size_t FixedGeometry<ROOT, MASK>::PEERS;
+
+/**
+ * @brief The board sizes that get a solver core of their own.
+ **/
+typedef FixedGeometry<2, std::uint16_t> Geometry4;
+typedef FixedGeometry<3, std::uint16_t> Geometry9;
+typedef FixedGeometry<4, std::uint32_t> Geometry16;
+typedef FixedGeometry<5, std::uint32_t> Geometry25;
+
+/**
+ * @brief The geometry of a board whose size is only known at run time
+ *
+ * @tparam MASK The type used for color masks, which must have at least n bits: a 64-bit integer
+ *              for boards up to 64*64, and a Bitset for the bigger ones.
+ **/
+template <class MASK>
+class DynamicGeometry
+{
+public:
+  typedef MASK mask_type;
+
+  /**
+   * @brief Construct the geometry of an n*n board
+   *
+   * @param n Side length of the board. Must be a perfect square.
+   **/
+  DynamicGeometry(std::size_t n)
+    : dim(n), dim_root(root_of(n)), peer_total(3 * n - 2 * dim_root - 1), block_table(n * n),
+      unit_table(3 * n * n), peer_table(n * n * peer_total)
+  {
+    GeometryTables::build(this->dim_root, this->block_table.data(), this->unit_table.data(),
+                          this->peer_table.data());
+  }
+
+  std::size_t n() const { return this->dim; }
+  std::size_t root() const { return this->dim_root; }
+  std::size_t cells() const { return this->dim * this->dim; }
+  std::size_t peer_count() const { return this->peer_total; }
+  mask_type all() const { return Bits::all_colors<mask_type>(this->dim); }
+
+  std::size_t row(std::size_t cell) const { return cell / this->dim; }
+  std::size_t column(std::size_t cell) const { return cell % this->dim; }
+  std::size_t block(std::size_t cell) const { return this->block_table[cell]; }
+  std::uint16_t const* unit(std::size_t u) const { return &this->unit_table[u * this->dim]; }
+  std::uint16_t const* peers(std::size_t cell) const
+  {
+    return &this->peer_table[cell * this->peer_total];
+  }
+
+private:
+  static std::size_t root_of(std::size_t n)
+  {
+    std::size_t root = 1;
+
+    while (root * root < n)
+    {
+      root++;
+    }
+
+    return root;
+  }
+
+  std::size_t dim, dim_root, peer_total;
+  std::vector<std::uint16_t> block_table, unit_table, peer_table;
+};
+
+#endif // GEOMETRY_H
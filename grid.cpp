@@ -19,41 +19,29 @@
 #include "grid.h"
 
 #include <sstream>
+#include <algorithm>
 
-Grid::Grid(std::size_t n) : matrix(boost::extents[n][n]), dim(n)
+Grid::Grid(std::size_t n) : dim(0)
 {
+  this->reset(n);
 }
 
-Grid::Grid(const Grid& grid) : matrix(grid.matrix), dim(grid.dim)
-{
-}
-
-Grid& Grid::operator=(const Grid& grid)
-{
-  this->matrix = grid.matrix;
-  this->dim = grid.dim;
-  return *this;
-}
-
-int Grid::get(std::size_t x, std::size_t y) const
-{
-  return this->matrix[y][x];
-}
-
-void Grid::set(std::size_t x, std::size_t y, int i)
+void Grid::reset(std::size_t n)
 {
-  this->matrix[y][x] = i;
-}
+  //keep at least one block around, so that cells() always points somewhere
+  std::size_t size = std::max<std::size_t>(n * n, 1);
+  this->blocks.assign((size + sizeof(Block) - 1) / sizeof(Block), Block());
+  this->dim = n;
 
-std::size_t Grid::n() const
-{
-  return this->dim;
+  if (this->has_candidates())
+  {
+    this->enable_candidates();
+  }
 }
 
-void Grid::reset(std::size_t n)
+void Grid::enable_candidates()
 {
-  this->matrix.resize(boost::extents[n][n]);
-  this->dim = n;
+  this->masks.assign(std::max<std::size_t>(this->dim * this->dim * this->candidate_words(), 1), 0);
 }
 
 std::string Grid::to_s() const
@@ -79,11 +67,7 @@ void Grid::to_s(std::ostream& out) const
         out << ' ';
       }
 
-      out << this->matrix[y][x];
+      out << this->get(x, y);
     }
   }
 }
-
-Grid::~Grid()
-{
-}
@@ -20,73 +20,169 @@
 #define GRID_H
 
 #include <cstddef>
+#include <cstdint>
 #include <string>
-#include <streambuf>
-#include <boost/multi_array.hpp>
+#include <vector>
+#include <ostream>
 
 /**
  * @brief A class that represents the state of a Sudoku board
  * 
  * The Grid class represents the current state of a particular Sudoku board. It is essentially a
  * wrapper around a square, 2D array, except that it does not need to be defined at compile-time.
- * The grid is stored in an underlying boost::multi_array<int, 2>, and it has all the typical
- * accessors: set an element, get an element, get the grid size, and set the grid size.
+ * Every cell takes a single byte, stored row after row in a flat buffer that is aligned for SIMD
+ * loads, with 0 as the unknown value; a 64*64 board takes 4 KiB. The grid may also keep the
+ * remaining candidates of every cell in a second, optional plane, as wide as the color masks of
+ * the board: one 64-bit word per cell up to 64*64, and two or three past that (see Bitset). The
+ * solver cores fill it in when they store a board into a grid that has one (see
+ * Kernel::propagate()).
+ *
+ * get() and set() still speak in terms of -1 for an unknown value, so that code written against
+ * the old int-based grid keeps working; cell() and cells() give the raw bytes.
  **/
 class Grid
 {
 public:
+  /**
+   * @brief The raw value of an unknown cell
+   **/
+  static const std::uint8_t UNKNOWN = 0;
+  /**
+   * @brief The side length of the biggest board the library handles (144*144)
+   **/
+  static const std::size_t MAX_N = 144;
+
   /**
    * @brief Construct a n*n grid
    *
    * @param n Side length of the square, 2D array.
    **/
   Grid(std::size_t n);
+
   /**
-   * @brief Copy-construct a grid from another grid
+   * @brief Resize the existing grid so that it is an n*n grid, with every cell unknown
    *
-   * @param grid The other grid.
+   * @param n Side length of the square, 2D array.
    **/
-  Grid(Grid const& grid);
-  virtual ~Grid();
+  void reset(std::size_t n);
 
   /**
-   * @brief Copy another grid
+   * @brief Get the value of a specific element
    *
-   * @param grid The other grid.
-   * @return Grid& The current grid.
+   * @param x The X-index of the element.
+   * @param y The Y-index of the element.
+   * @return int The value of the element, or -1 if it is unknown.
    **/
-  Grid& operator =(Grid const& grid);
+  int get(std::size_t x, std::size_t y) const
+  {
+    int value = this->cell(x, y);
+    return (value == UNKNOWN) ? -1 : value;
+  }
+  /**
+   * @brief Set the value of a specific element
+   *
+   * @param x The X-index of the element.
+   * @param y The Y-index of the element.
+   * @param i The new value of the element, or -1 if it is unknown.
+   **/
+  void set(std::size_t x, std::size_t y, int i)
+  {
+    this->data()[y * this->dim + x] = (i <= 0) ? UNKNOWN : std::uint8_t(i);
+  }
 
   /**
-   * @brief Resize the existing grid so that it is an n*n grid
+   * @brief Get the raw value of a specific element
    *
-   * @param n Side length of the square, 2D array.
+   * @param x The X-index of the element.
+   * @param y The Y-index of the element.
+   * @return std::uint8_t The value of the element, or UNKNOWN.
    **/
-  void reset(std::size_t n);
+  std::uint8_t cell(std::size_t x, std::size_t y) const
+  {
+    return this->cells()[y * this->dim + x];
+  }
+  /**
+   * @brief The raw values of every element, row after row
+   *
+   * @return const std::uint8_t* The n*n values, aligned to 16 bytes.
+   **/
+  std::uint8_t const* cells() const
+  {
+    return this->blocks[0].bytes;
+  }
 
   /**
-   * @brief Get the value of a specific element
+   * @brief Start keeping the candidates of every cell, with every candidate cleared
+   **/
+  void enable_candidates();
+  /**
+   * @brief Whether the grid keeps the candidates of every cell
+   *
+   * @return bool True if it does.
+   **/
+  bool has_candidates() const
+  {
+    return !this->masks.empty();
+  }
+  /**
+   * @brief The number of 64-bit words that hold the candidates of a cell
+   *
+   * @return std::size_t Enough words for one bit per value.
+   **/
+  std::size_t candidate_words() const
+  {
+    return (this->dim + 63) / 64;
+  }
+  /**
+   * @brief Get the candidates of a specific element, with bit i-1 standing for the value i
+   *
+   * Only valid if has_candidates().
    *
    * @param x The X-index of the element.
    * @param y The Y-index of the element.
-   * @return int The value of the element.
+   * @return const std::uint64_t* The candidate_words() words of the mask, least significant first.
    **/
-  int get(std::size_t x, std::size_t y) const;
+  std::uint64_t const* candidates(std::size_t x, std::size_t y) const
+  {
+    return &this->masks[(y * this->dim + x) * this->candidate_words()];
+  }
   /**
-   * @brief Set the value of a specific element
+   * @brief Get the candidates of a specific element, to change them
+   *
+   * Only valid if has_candidates().
    *
    * @param x The X-index of the element.
    * @param y The Y-index of the element.
-   * @param i The new value of the element.
+   * @return std::uint64_t* The candidate_words() words of the mask, least significant first.
    **/
-  void set(std::size_t x, std::size_t y, int i);
+  std::uint64_t* candidates(std::size_t x, std::size_t y)
+  {
+    return &this->masks[(y * this->dim + x) * this->candidate_words()];
+  }
+  /**
+   * @brief Whether a value is among the candidates of a specific element
+   *
+   * Only valid if has_candidates().
+   *
+   * @param x The X-index of the element.
+   * @param y The Y-index of the element.
+   * @param i The value, between 1 and n.
+   * @return bool True if it is.
+   **/
+  bool is_candidate(std::size_t x, std::size_t y, int i) const
+  {
+    return (this->candidates(x, y)[(i - 1) / 64] >> ((i - 1) % 64)) & 1;
+  }
 
   /**
    * @brief The side length of the square, 2D array
    *
    * @return std::size_t The side-length.
    **/
-  std::size_t n() const;
+  std::size_t n() const
+  {
+    return this->dim;
+  }
   
   /**
    * @brief Show the grid in a human-readable form.
@@ -103,9 +199,26 @@ public:
 
 private:
   /**
-   * @brief The underlying grid.
+   * @brief A piece of the underlying buffer, which keeps the cells aligned for SIMD loads
+   **/
+  struct alignas(16) Block
+  {
+    std::uint8_t bytes[16];
+  };
+
+  std::uint8_t* data()
+  {
+    return this->blocks[0].bytes;
+  }
+
+  /**
+   * @brief The underlying cells, padded to a whole number of blocks.
+   **/
+  std::vector<Block> blocks;
+  /**
+   * @brief The candidate masks of every cell, or nothing if the grid does not keep them.
    **/
-  boost::multi_array<int, 2> matrix;
+  std::vector<std::uint64_t> masks;
   /**
    * @brief The side length of the grid.
    **/
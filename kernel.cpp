@@ -0,0 +1,204 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "kernel.h"
+#include "bitboard.h"
+#include "geometry.h"
+#include "parallel.h"
+#include "solver.h"
+
+/**
+ * @brief The kernel for the boards of a particular geometry
+ **/
+template <class Geometry>
+class BasicKernel : public Kernel
+{
+public:
+  BasicKernel(std::size_t n)
+    : geometry(n), board(geometry), solver(geometry), stats(nullptr), watchdog(nullptr)
+  {
+  }
+
+  std::size_t n() const
+  {
+    return this->geometry.n();
+  }
+
+  void watch(SolveStats* stats)
+  {
+    this->stats = stats;
+    this->solver.watch(stats);
+  }
+
+  void guard(Watchdog* watchdog)
+  {
+    this->watchdog = watchdog;
+    this->solver.guard(watchdog);
+  }
+
+  bool solve(Grid& grid, Branching policy)
+  {
+    this->board.load(grid);
+
+    if (this->solver.solve(this->board, policy))
+    {
+      this->board.store(grid);
+      return true;
+    }
+
+    return false;
+  }
+
+  std::size_t count(Grid const& grid, std::size_t limit, Grid* witnesses, std::size_t room,
+                    std::size_t budget)
+  {
+    this->board.load(grid);
+    return this->solver.count(this->board, limit, witnesses, room, budget);
+  }
+
+  bool propagate(Grid& grid)
+  {
+    this->board.load(grid);
+
+    if (this->board.propagate())
+    {
+      this->board.store(grid);
+      return true;
+    }
+
+    return false;
+  }
+
+  bool bruteforce(Grid& grid)
+  {
+    return this->solver.bruteforce(grid);
+  }
+
+  bool solve_parallel(Grid& grid, Branching policy, ThreadPool& pool)
+  {
+    ParallelSearch<Geometry> search(pool, this->geometry);
+    this->board.load(grid);
+    return search.run(this->board, policy, 1, &grid, this->stats, this->watchdog) == 1;
+  }
+
+  std::size_t count_parallel(Grid const& grid, std::size_t limit, ThreadPool& pool)
+  {
+    ParallelSearch<Geometry> search(pool, this->geometry);
+    this->board.load(grid);
+    return search.run(this->board, Branching::MOST_CONSTRAINED, limit, nullptr, this->stats,
+                      this->watchdog);
+  }
+
+private:
+  Geometry geometry;
+  BasicBoard<Geometry> board;
+  BasicSolver<Geometry> solver;
+  SolveStats* stats;
+  Watchdog* watchdog;
+};
+
+/**
+ * @brief The kernel for 9*9 boards, which also has the bitboard solver
+ **/
+class NineKernel : public BasicKernel<Geometry9>
+{
+public:
+  NineKernel() : BasicKernel<Geometry9>(9)
+  {
+  }
+
+  void watch(SolveStats* stats)
+  {
+    BasicKernel<Geometry9>::watch(stats);
+    this->bitboard.watch(stats);
+  }
+
+  void guard(Watchdog* watchdog)
+  {
+    BasicKernel<Geometry9>::guard(watchdog);
+    this->bitboard.guard(watchdog);
+  }
+
+  bool solve_bitboard(Grid& grid)
+  {
+    if (this->bitboard.load(grid) && this->bitboard.solve())
+    {
+      this->bitboard.store(grid);
+      return true;
+    }
+
+    return false;
+  }
+
+  std::size_t count(Grid const& grid, std::size_t limit, Grid* witnesses, std::size_t room,
+                    std::size_t budget)
+  {
+    if (!this->bitboard.load(grid))
+    {
+      return 0;
+    }
+
+    std::size_t found = this->bitboard.count(limit, budget);
+
+    //the bitboard solver only keeps the first two solutions around
+    for (std::size_t i = 0; i < room && i < found && i < 2; i++)
+    {
+      this->bitboard.store(witnesses[i], i);
+    }
+
+    return found;
+  }
+
+private:
+  BitboardSolver bitboard;
+};
+
+Kernel::~Kernel()
+{
+}
+
+bool Kernel::solve_bitboard(Grid& grid)
+{
+  return this->solve(grid, Branching::MOST_CONSTRAINED);
+}
+
+std::unique_ptr<Kernel> Kernel::create(std::size_t n)
+{
+  switch (n)
+  {
+    case 4: { return std::unique_ptr<Kernel>(new BasicKernel<Geometry4>(n)); }
+    case 9: { return std::unique_ptr<Kernel>(new NineKernel()); }
+    case 16: { return std::unique_ptr<Kernel>(new BasicKernel<Geometry16>(n)); }
+    case 25: { return std::unique_ptr<Kernel>(new BasicKernel<Geometry25>(n)); }
+    default: { break; }
+  }
+
+  //the other sizes pick the narrowest mask that holds all their colors
+  if (n <= 64)
+  {
+    return std::unique_ptr<Kernel>(new BasicKernel<DynamicGeometry<std::uint_fast64_t>>(n));
+  }
+  else if (n <= 128)
+  {
+    return std::unique_ptr<Kernel>(new BasicKernel<DynamicGeometry<Mask128>>(n));
+  }
+  else
+  {
+    return std::unique_ptr<Kernel>(new BasicKernel<DynamicGeometry<Mask192>>(n));
+  }
+}
@@ -0,0 +1,142 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KERNEL_H
+#define KERNEL_H
+
+#include <cstddef>
+#include <memory>
+
+#include "board.h"
+#include "grid.h"
+#include "stats.h"
+#include "watchdog.h"
+#include "thread_pool.h"
+
+/**
+ * @brief A solver core built for one particular board size
+ *
+ * The search code (BasicBoard and BasicSolver) is a template over the shape of the board. For the
+ * common sizes (4*4, 9*9, 16*16 and 25*25) it is instantiated with a FixedGeometry, where the side
+ * length, the block size, and the width of the color masks are compile-time constants; every other
+ * size gets the generic DynamicGeometry, with a multi-word Bitset for masks past 64 colors. A
+ * Kernel hides which one is in use behind a virtual interface, so the Sudoku class can pick the
+ * right one once, as soon as it knows how big the puzzle is. A kernel keeps its board and its
+ * decision stack between calls, so solving a stream of puzzles of the same size does not allocate.
+ **/
+class Kernel
+{
+public:
+  virtual ~Kernel();
+
+  /**
+   * @brief Create the fastest kernel available for n*n boards
+   *
+   * @param n Side length of the boards. Must be a perfect square no bigger than Grid::MAX_N.
+   * @return std::unique_ptr<Kernel> The kernel.
+   **/
+  static std::unique_ptr<Kernel> create(std::size_t n);
+
+  /**
+   * @brief The side length of the boards this kernel handles
+   *
+   * @return std::size_t The side-length.
+   **/
+  virtual std::size_t n() const = 0;
+  /**
+   * @brief Fill in some statistics during every solve and count from now on (see SolveStats)
+   *
+   * @param stats Where to add the counts, or nullptr to stop counting.
+   **/
+  virtual void watch(SolveStats* stats) = 0;
+  /**
+   * @brief Keep every solve from now on within some limits (see Watchdog). A solve that runs out
+   *        of them leaves the grid unchanged and returns false, and the watchdog is tripped.
+   *
+   * @param watchdog The limits, or nullptr for none.
+   **/
+  virtual void guard(Watchdog* watchdog) = 0;
+
+  /**
+   * @brief Solve a puzzle using the graph n-colorability method (see BasicSolver::solve())
+   *
+   * @param grid The Sudoku board. If a solution is found, it overwrites the board.
+   * @param policy The order in which the nodes are colored.
+   * @return bool Whether a solution was found.
+   **/
+  virtual bool solve(Grid& grid, Branching policy) = 0;
+  /**
+   * @brief Count the solutions of a puzzle, stopping early once a limit is reached
+   *
+   * @param grid The Sudoku board.
+   * @param limit The number of solutions after which the search gives up.
+   * @param witnesses Where to copy the first solutions found, if anywhere. The grids must have
+   *                  the same size as the board.
+   * @param room The number of grids in witnesses.
+   * @param budget The number of search nodes after which the search gives up, as if it had
+   *               reached the limit.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  virtual std::size_t count(Grid const& grid, std::size_t limit, Grid* witnesses,
+                            std::size_t room, std::size_t budget) = 0;
+  /**
+   * @brief Color every forced cell of a puzzle, without searching (see BasicBoard::propagate())
+   *
+   * @param grid The Sudoku board. If it is still consistent afterwards, the forced cells are
+   *             filled in, along with the candidates of every cell if the grid keeps them.
+   * @return bool Whether the board is still consistent.
+   **/
+  virtual bool propagate(Grid& grid) = 0;
+  /**
+   * @brief Solve a puzzle by brute force (see BasicSolver::bruteforce())
+   *
+   * @param grid The Sudoku board. If a solution is found, it overwrites the board.
+   * @return bool Whether a solution was found.
+   **/
+  virtual bool bruteforce(Grid& grid) = 0;
+  /**
+   * @brief Solve a puzzle with the bitboard solver (see BitboardSolver), which only exists for 9*9
+   *        boards. The other kernels fall back to solve() with the most constrained cell first.
+   *
+   * @param grid The Sudoku board. If a solution is found, it overwrites the board.
+   * @return bool Whether a solution was found.
+   **/
+  virtual bool solve_bitboard(Grid& grid);
+
+  /**
+   * @brief Solve a puzzle on all the workers of a pool at once (see ParallelSearch)
+   *
+   * @param grid The Sudoku board. If a solution is found, it overwrites the board.
+   * @param policy The order in which the nodes are colored.
+   * @param pool The workers, which must be idle.
+   * @return bool Whether a solution was found.
+   **/
+  virtual bool solve_parallel(Grid& grid, Branching policy, ThreadPool& pool) = 0;
+  /**
+   * @brief Count the solutions of a puzzle on all the workers of a pool at once, stopping all of
+   *        them once a limit is reached
+   *
+   * @param grid The Sudoku board.
+   * @param limit The number of solutions after which the search gives up.
+   * @param pool The workers, which must be idle.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  virtual std::size_t count_parallel(Grid const& grid, std::size_t limit, ThreadPool& pool) = 0;
+};
+
+#endif // KERNEL_H
@@ -17,11 +17,464 @@
  */
 
 #include "sudoku.h"
+#include "batch.h"
+#include "generator.h"
+#include "packed.h"
+#include "reader.h"
+#include "serializer.h"
+#include "server.h"
+#include <chrono>
+#include <csignal>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <unistd.h>
+
+/**
+ * @brief Solve every puzzle of a file on a pool of threads (see BatchSolver), and print a summary
+ *        of the throughput to stderr. The file is memory-mapped when it can be, which includes
+ *        standard input redirected from a file, and read a block at a time otherwise (say, from a
+ *        pipe).
+ *
+ * @param path The file of puzzles, or an empty string for standard input.
+ * @param threads The number of threads, or 0 for one per hardware thread.
+ * @param timeout How long each puzzle may take, in milliseconds, or 0 for no limit.
+ * @return int The exit status.
+ **/
+static int solve_batch(std::string const& path, std::size_t threads, std::size_t timeout)
+{
+  BatchSolver solver(threads, SolveLimits(), std::chrono::milliseconds(timeout));
+  BatchSolver::Summary summary;
+  MappedFile file;
+
+  if (!path.empty() && !file.open(path))
+  {
+    std::cerr << file.error() << std::endl;
+    return 1;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+
+  bool mapped = !path.empty() || file.map(STDIN_FILENO);
+
+  if (mapped && PackedCorpus::detect(file.data(), file.size()))
+  {
+    PackedCorpus corpus;
+
+    if (!corpus.open(file.data(), file.size()))
+    {
+      std::cerr << (path.empty() ? "stdin" : path) << ": " << corpus.error() << std::endl;
+      return 1;
+    }
+
+    summary = solver.solve(corpus, std::cout, &std::cerr);
+  }
+  else if (mapped)
+  {
+    summary = solver.solve(PuzzleReader(file.data(), file.size()), std::cout, &std::cerr);
+  }
+  else
+  {
+    summary = solver.solve(std::cin, std::cout, &std::cerr);
+  }
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double seconds = elapsed.count();
+
+  std::cerr << summary.total << " puzzles (" << summary.solved << " solved, "
+            << summary.unsolvable << " unsolvable, " << summary.aborted << " aborted, "
+            << summary.invalid << " invalid) in "
+            << seconds << " s on " << solver.threads() << " threads: "
+            << (seconds > 0 ? summary.total / seconds : 0) << " puzzles/s" << std::endl;
+
+  return (summary.invalid == 0 && summary.aborted == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Get the whole of a file into memory: mapped, when it can be, and read otherwise (say, from
+ *        a pipe)
+ *
+ * @param path The file, or an empty string for standard input.
+ * @param file The mapping.
+ * @param copy Set to the contents of the file, if it could not be mapped.
+ * @return bool Whether the file could be opened. If not, the mapping tells why.
+ **/
+static bool load_input(std::string const& path, MappedFile& file, std::string& copy)
+{
+  if (!path.empty())
+  {
+    return file.open(path);
+  }
+
+  if (!file.map(STDIN_FILENO))
+  {
+    copy.assign(std::istreambuf_iterator<char>(std::cin), std::istreambuf_iterator<char>());
+  }
+
+  return true;
+}
+
+/**
+ * @brief Convert a file of puzzles in the text formats into a packed file (see PackedFormat). The
+ *        puzzles that cannot be read, or that are not of the size of the first one, are left out
+ *        and reported on stderr.
+ *
+ * @param path The file of puzzles, or an empty string for standard input.
+ * @param output The path of the packed file.
+ * @return int The exit status.
+ **/
+static int pack_puzzles(std::string const& path, std::string const& output)
+{
+  MappedFile file;
+  std::string copy;
+
+  if (!load_input(path, file, copy))
+  {
+    std::cerr << file.error() << std::endl;
+    return 1;
+  }
+
+  std::ofstream out(output.c_str(), std::ios::binary | std::ios::trunc);
+
+  if (!out)
+  {
+    std::cerr << output << ": " << std::strerror(errno) << std::endl;
+    return 1;
+  }
+
+  PuzzleReader reader = copy.empty() ? PuzzleReader(file.data(), file.size())
+                                     : PuzzleReader(copy.data(), copy.size());
+  std::unique_ptr<PackedWriter> writer;
+  std::size_t skipped = 0;
+  Grid grid(0);
+
+  while (!reader.done())
+  {
+    std::size_t start = reader.offset();
+
+    if (!reader.next(grid))
+    {
+      std::cerr << "offset " << reader.error_offset() << ": " << reader.error_message()
+                << std::endl;
+      skipped++;
+      continue;
+    }
+
+    //the first puzzle decides the size of every record
+    if (!writer)
+    {
+      writer.reset(new PackedWriter(out, grid.n()));
+    }
+
+    if (grid.n() != writer->n())
+    {
+      std::cerr << "offset " << start << ": the puzzle is " << grid.n() << "*" << grid.n()
+                << ", but the file holds " << writer->n() << "*" << writer->n() << " puzzles"
+                << std::endl;
+      skipped++;
+      continue;
+    }
+
+    writer->write(grid);
+  }
+
+  if (!writer)
+  {
+    writer.reset(new PackedWriter(out, 9));
+  }
+
+  if (!writer->finish())
+  {
+    std::cerr << output << ": the file could not be written" << std::endl;
+    return 1;
+  }
+
+  std::cerr << writer->count() << " puzzles packed into " << out.tellp() << " bytes ("
+            << skipped << " left out)" << std::endl;
+
+  return (skipped == 0) ? 0 : 1;
+}
+
+/**
+ * @brief Write the records of a packed file (see PackedFormat) to stdout, in the single line format
+ *        (or as grids separated by blank lines, for boards bigger than 25x25)
+ *
+ * @param path The packed file, or an empty string for standard input.
+ * @return int The exit status.
+ **/
+static int unpack_puzzles(std::string const& path)
+{
+  MappedFile file;
+  std::string copy;
+
+  if (!load_input(path, file, copy))
+  {
+    std::cerr << file.error() << std::endl;
+    return 1;
+  }
+
+  PackedCorpus corpus;
+  bool opened = copy.empty() ? corpus.open(file.data(), file.size())
+                             : corpus.open(copy.data(), copy.size());
+
+  if (!opened)
+  {
+    std::cerr << (path.empty() ? "stdin" : path) << ": " << corpus.error() << std::endl;
+    return 1;
+  }
+
+  Grid grid(corpus.n());
+  std::string text;
+  int status = 0;
+  const Layout layout = (corpus.n() <= 25) ? Layout::COMPACT : Layout::SPACED;
+
+  for (std::size_t i = 0; i < corpus.size(); i++)
+  {
+    if (!corpus.get(i, grid))
+    {
+      std::cerr << "record " << i << ": a value is out of range" << std::endl;
+      status = 1;
+      continue;
+    }
+
+    text.resize(Serializer::size(grid, layout));
+    Serializer::write(grid, layout, &text[0], text.size());
+    std::cout.write(text.data(), text.size());
+    std::cout << ((layout == Layout::COMPACT) ? "\n" : "\n\n");
+  }
+
+  return status;
+}
+
+/**
+ * @brief Generate puzzles with unique solutions on a pool of threads (see Generator), write them to
+ *        stdout, and print a summary of the throughput to stderr
+ *
+ * @param options What kind of puzzles to generate.
+ * @param count The number of puzzles.
+ * @param threads The number of threads, or 0 for one per hardware thread.
+ * @return int The exit status.
+ **/
+static int generate_puzzles(Generator::Options const& options, std::size_t count,
+                            std::size_t threads)
+{
+  Generator generator(options, threads);
+
+  auto start = std::chrono::steady_clock::now();
+  Generator::Summary summary = generator.generate(count, std::cout);
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  double seconds = elapsed.count();
+
+  std::cerr << summary.total << " puzzles";
+
+  //without a target, the generator takes out as many clues as it can, so none are over
+  if (options.clues != 0)
+  {
+    std::cerr << " (" << summary.over << " above " << options.clues << " clues)";
+  }
+
+  std::cerr << " in " << seconds << " s on " << generator.threads() << " threads: "
+            << (seconds > 0 ? summary.total / seconds : 0) << " puzzles/s" << std::endl;
+
+  return 0;
+}
+
+/**
+ * @brief Answer requests on a pool of threads (see Server), either over standard input and output
+ *        or from every client of a Unix domain socket, and print a summary to stderr when the
+ *        requests on standard input run out
+ *
+ * @param path The path of the socket, or an empty string for standard input and output.
+ * @param threads The number of threads, or 0 for one per hardware thread.
+ * @param cache The number of solutions to cache, or 0 for none.
+ * @return int The exit status.
+ **/
+static int serve_requests(std::string const& path, std::size_t threads, std::size_t cache)
+{
+  Server server(threads, cache);
+
+  //a client that goes away must not take the server down with it
+  std::signal(SIGPIPE, SIG_IGN);
+
+  if (!path.empty())
+  {
+    server.listen(path);
+    std::cerr << server.error() << std::endl;
+    return 1;
+  }
+
+  Server::Summary summary = server.serve(STDIN_FILENO, STDOUT_FILENO);
+
+  std::cerr << summary.total << " requests (" << summary.ok << " ok, " << summary.unsolvable
+            << " unsolvable, " << summary.aborted << " aborted, " << summary.invalid
+            << " invalid, " << summary.bad << " bad) on " << server.threads() << " threads"
+            << std::endl;
+
+  if (cache > 0)
+  {
+    SolutionCache::Metrics metrics = server.cache_metrics();
+    std::cerr << "cache: " << metrics.hits << " hits in " << metrics.lookups << " lookups ("
+              << 100 * metrics.hit_rate() << "%), " << metrics.entries << " entries, "
+              << metrics.evictions << " evictions, " << 1e6 * metrics.lookup_seconds()
+              << " us per lookup" << std::endl;
+  }
+
+  return 0;
+}
+
+/**
+ * @brief Parse a whole command-line argument as a number
+ *
+ * @param text The argument.
+ * @param value Set to the number.
+ * @return bool Whether the argument is a number.
+ **/
+static bool parse_number(char const* text, std::size_t& value)
+{
+  char* end;
+  value = std::strtoull(text, &end, 10);
+  return *text != '\0' && *text != '-' && *end == '\0';
+}
 
 int main(int argc, char* argv[])
 {
+  bool batch = false, generate = false, serve = false, threaded = false, stats = false;
+  bool pack = false, unpack = false, usage = false;
+  std::size_t threads = 0, count = 0, seed = 0, timeout = 0, cache = 0;
+  std::string path, output;
+  Generator::Options options;
+
+  for (int i = 1; i < argc && !usage; i++)
+  {
+    if (std::strcmp(argv[i], "--batch") == 0)
+    {
+      batch = true;
+    }
+    else if (std::strcmp(argv[i], "--server") == 0)
+    {
+      serve = true;
+    }
+    else if (std::strcmp(argv[i], "--pack") == 0 && i + 1 < argc)
+    {
+      pack = true;
+      output = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "--unpack") == 0)
+    {
+      unpack = true;
+    }
+    else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+    {
+      threaded = true;
+      usage = !parse_number(argv[++i], threads);
+    }
+    else if (std::strcmp(argv[i], "--stats") == 0)
+    {
+      stats = true;
+    }
+    else if (std::strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+    {
+      usage = !parse_number(argv[++i], cache);
+    }
+    else if (std::strcmp(argv[i], "--timeout") == 0 && i + 1 < argc)
+    {
+      usage = !parse_number(argv[++i], timeout);
+    }
+    else if (std::strcmp(argv[i], "--generate") == 0 && i + 1 < argc)
+    {
+      generate = true;
+      usage = !parse_number(argv[++i], count);
+    }
+    else if (std::strcmp(argv[i], "--size") == 0 && i + 1 < argc)
+    {
+      usage = !parse_number(argv[++i], options.n);
+    }
+    else if (std::strcmp(argv[i], "--clues") == 0 && i + 1 < argc)
+    {
+      usage = !parse_number(argv[++i], options.clues);
+    }
+    else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+    {
+      usage = !parse_number(argv[++i], seed);
+      options.seed = seed;
+    }
+    else if (std::strcmp(argv[i], "--symmetry") == 0 && i + 1 < argc)
+    {
+      std::string symmetry = argv[++i];
+      options.symmetry = (symmetry == "rotational") ? Symmetry::ROTATIONAL :
+                         (symmetry == "mirror") ? Symmetry::MIRROR : Symmetry::NONE;
+      usage = (symmetry != "rotational" && symmetry != "mirror" && symmetry != "none");
+    }
+    else if ((batch || serve || pack || unpack) && path.empty() && argv[i][0] != '-')
+    {
+      path = argv[i];
+    }
+    else
+    {
+      usage = true;
+    }
+  }
+
+  //the generator takes boards whose side is a perfect square, from 4*4 up to 36*36
+  std::size_t root = 2;
+
+  while (root * root < options.n)
+  {
+    root++;
+  }
+
+  usage = usage || (batch + generate + serve + pack + unpack > 1) || root * root != options.n ||
+          options.n > Generator::MAX_N;
+
+  if (usage)
+  {
+    std::cerr << "usage: " << argv[0] << " [--batch [FILE]] [--threads N] [--stats] [--timeout MS]"
+              << std::endl
+              << "       " << argv[0] << " --generate COUNT [--size 4|9|16|25|36] [--clues N]"
+              << " [--symmetry none|rotational|mirror] [--seed N] [--threads N]" << std::endl
+              << "       " << argv[0] << " --server [SOCKET] [--threads N] [--cache N]"
+              << std::endl
+              << "       " << argv[0] << " --pack OUTPUT [FILE] | --unpack [FILE]" << std::endl;
+    return 2;
+  }
+
+  if (generate)
+  {
+    //one line per puzzle, as in batch mode
+    std::ios_base::sync_with_stdio(false);
+    return generate_puzzles(options, count, threads);
+  }
+
+  if (pack)
+  {
+    return pack_puzzles(path, output);
+  }
+
+  if (unpack)
+  {
+    std::ios_base::sync_with_stdio(false);
+    return unpack_puzzles(path);
+  }
+
+  if (serve)
+  {
+    return serve_requests(path, threads, cache);
+  }
+
+  if (batch)
+  {
+    //one line per solution, so there is no reason to keep stdio in sync with iostreams
+    std::ios_base::sync_with_stdio(false);
+    return solve_batch(path, threads, timeout);
+  }
+
   Sudoku puzzle;
+  puzzle.collect_stats(stats);
   puzzle.read_puzzle_from_file(std::cin);
 
   if (puzzle)
@@ -39,10 +492,40 @@ int main(int argc, char* argv[])
 
   std::cout << std::endl << "Solving the puzzle..." << std::endl;
 
-  puzzle.solve_colorability_style();
+  //a timeout of 0 means there is none
+  SolveLimits limits;
 
-  std::cout << "A solution was found!" << std::endl;
-  puzzle.print(std::cout);
+  if (timeout > 0)
+  {
+    limits = SolveLimits::within(std::chrono::milliseconds(timeout));
+  }
 
-  return 0;
+  //a single puzzle only goes parallel when asked to, since it costs a thread pool
+  SolveResult result = threaded ? puzzle.solve_parallel_style(threads, limits) :
+                                  puzzle.solve_colorability_style(limits);
+
+  if (result == SolveResult::SOLVED)
+  {
+    std::cout << "A solution was found!" << std::endl;
+    puzzle.print(std::cout);
+  }
+  else if (result == SolveResult::ABORTED)
+  {
+    std::cout << "The solve was aborted after " << timeout << " ms." << std::endl;
+  }
+  else
+  {
+    std::cout << "The puzzle has no solution." << std::endl;
+  }
+
+  if (stats)
+  {
+    SolveStats const& solve = puzzle.stats();
+    std::cerr << "nodes " << solve.nodes << ", backtracks " << solve.backtracks << ", max depth "
+              << solve.max_depth << ", validator calls " << solve.validator_calls
+              << ", propagations " << solve.propagations << ", " << solve.seconds << " s"
+              << std::endl;
+  }
+
+  return (result == SolveResult::SOLVED) ? 0 : 1;
 }
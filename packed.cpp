@@ -0,0 +1,291 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "packed.h"
+
+#include <cstring>
+
+namespace
+{
+  char const MAGIC[4] = {'S', 'D', 'K', 'P'};
+  std::uint8_t const VERSION = 1;
+
+  /**
+   * @brief Where the number of records is in the header
+   **/
+  std::size_t const COUNT_OFFSET = 8;
+
+  void put_u64(char* bytes, std::uint64_t value)
+  {
+    for (std::size_t i = 0; i < 8; i++)
+    {
+      bytes[i] = char(value >> (8 * i));
+    }
+  }
+
+  std::uint64_t get_u64(char const* bytes)
+  {
+    std::uint64_t value = 0;
+
+    for (std::size_t i = 0; i < 8; i++)
+    {
+      value |= std::uint64_t(std::uint8_t(bytes[i])) << (8 * i);
+    }
+
+    return value;
+  }
+
+  /**
+   * @brief Whether n is the side length of a board that the solvers take
+   **/
+  bool is_board_size(std::size_t n)
+  {
+    std::size_t root = 1;
+
+    while (root * root < n)
+    {
+      root++;
+    }
+
+    return n >= 1 && n <= Grid::MAX_N && root * root == n;
+  }
+}
+
+std::size_t PackedFormat::bits(std::size_t n)
+{
+  std::size_t width = 1;
+
+  while ((std::size_t(1) << width) <= n)
+  {
+    width++;
+  }
+
+  return width;
+}
+
+std::size_t PackedFormat::record_bytes(std::size_t n)
+{
+  return (n * n * bits(n) + 7) / 8;
+}
+
+void PackedFormat::pack(std::uint8_t const* cells, std::size_t n, char* record)
+{
+  std::size_t const width = bits(n);
+  std::uint64_t buffer = 0;
+  std::size_t filled = 0;
+
+  //the cells go into a bit buffer, which is emptied a byte at a time
+  for (std::size_t i = 0; i < n * n; i++)
+  {
+    buffer |= std::uint64_t(cells[i]) << filled;
+    filled += width;
+
+    while (filled >= 8)
+    {
+      *record++ = char(buffer);
+      buffer >>= 8;
+      filled -= 8;
+    }
+  }
+
+  if (filled > 0)
+  {
+    *record = char(buffer);
+  }
+}
+
+bool PackedFormat::unpack(char const* record, std::size_t n, std::uint8_t* cells)
+{
+  std::size_t const width = bits(n);
+  std::uint64_t const mask = (std::uint64_t(1) << width) - 1;
+  std::uint64_t buffer = 0;
+  std::size_t filled = 0;
+  bool good = true;
+
+  for (std::size_t i = 0; i < n * n; i++)
+  {
+    while (filled < width)
+    {
+      buffer |= std::uint64_t(std::uint8_t(*record++)) << filled;
+      filled += 8;
+    }
+
+    std::uint8_t value = std::uint8_t(buffer & mask);
+    buffer >>= width;
+    filled -= width;
+
+    cells[i] = value;
+    good &= (value <= n);
+  }
+
+  return good;
+}
+
+bool PackedFormat::unpack(char const* record, std::size_t n, Grid& grid)
+{
+  std::uint8_t cells[Grid::MAX_N * Grid::MAX_N];
+  bool good = unpack(record, n, cells);
+
+  if (grid.n() != n)
+  {
+    grid.reset(n);
+  }
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      grid.set(x, y, cells[y * n + x]);
+    }
+  }
+
+  return good;
+}
+
+PackedWriter::PackedWriter(std::ostream& out, std::size_t n)
+  : out(out), dim(n), records(0), record(PackedFormat::record_bytes(n), '\0')
+{
+  char header[PackedFormat::HEADER_BYTES] = {};
+
+  std::memcpy(header, MAGIC, sizeof(MAGIC));
+  header[4] = char(VERSION);
+  header[5] = char(n);
+  header[6] = char(PackedFormat::bits(n));
+  put_u64(header + COUNT_OFFSET, 0);
+
+  this->out.write(header, sizeof(header));
+}
+
+void PackedWriter::write(Grid const& grid)
+{
+  this->write(grid.cells());
+}
+
+void PackedWriter::write(std::uint8_t const* cells)
+{
+  PackedFormat::pack(cells, this->dim, &this->record[0]);
+  this->out.write(this->record.data(), this->record.size());
+  this->records++;
+}
+
+bool PackedWriter::finish()
+{
+  char count[8];
+  put_u64(count, this->records);
+
+  this->out.flush();
+  std::ostream::pos_type end = this->out.tellp();
+
+  this->out.seekp(COUNT_OFFSET);
+  this->out.write(count, sizeof(count));
+  this->out.seekp(end);
+  this->out.flush();
+
+  return bool(this->out);
+}
+
+std::size_t PackedWriter::n() const
+{
+  return this->dim;
+}
+
+std::size_t PackedWriter::count() const
+{
+  return this->records;
+}
+
+PackedCorpus::PackedCorpus() : records(nullptr), dim(0), stride(0), count(0)
+{
+}
+
+bool PackedCorpus::detect(char const* data, std::size_t size)
+{
+  return size >= sizeof(MAGIC) && std::memcmp(data, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool PackedCorpus::open(char const* data, std::size_t size)
+{
+  this->records = nullptr;
+  this->dim = this->stride = this->count = 0;
+
+  if (size < PackedFormat::HEADER_BYTES || !detect(data, size))
+  {
+    this->message = "not a packed file";
+    return false;
+  }
+
+  std::size_t n = std::uint8_t(data[5]);
+
+  if (std::uint8_t(data[4]) != VERSION)
+  {
+    this->message = "unknown version of the packed format";
+    return false;
+  }
+
+  if (!is_board_size(n) || std::uint8_t(data[6]) != PackedFormat::bits(n))
+  {
+    this->message = "the header does not describe a board of up to 144*144 cells";
+    return false;
+  }
+
+  //compare the number of records with what fits, so that a huge count cannot overflow
+  std::uint64_t records = get_u64(data + COUNT_OFFSET);
+  std::size_t stride = PackedFormat::record_bytes(n), room = size - PackedFormat::HEADER_BYTES;
+
+  if (records != room / stride || room % stride != 0)
+  {
+    this->message = "the size of the file does not match the number of records";
+    return false;
+  }
+
+  this->records = data + PackedFormat::HEADER_BYTES;
+  this->dim = n;
+  this->stride = stride;
+  this->count = std::size_t(records);
+  return true;
+}
+
+std::size_t PackedCorpus::n() const
+{
+  return this->dim;
+}
+
+std::size_t PackedCorpus::size() const
+{
+  return this->count;
+}
+
+char const* PackedCorpus::record(std::size_t index) const
+{
+  return this->records + index * this->stride;
+}
+
+bool PackedCorpus::get(std::size_t index, Grid& grid) const
+{
+  return PackedFormat::unpack(this->record(index), this->dim, grid);
+}
+
+bool PackedCorpus::get(std::size_t index, std::uint8_t* cells) const
+{
+  return PackedFormat::unpack(this->record(index), this->dim, cells);
+}
+
+std::string const& PackedCorpus::error() const
+{
+  return this->message;
+}
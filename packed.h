@@ -0,0 +1,190 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PACKED_H
+#define PACKED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+#include "grid.h"
+
+/**
+ * @brief A packed binary format for corpora of puzzles (or solutions) that all have the same size
+ *
+ * A file starts with a 16-byte header: the magic bytes "SDKP", a version byte (1), the side length
+ * n, the number of bits per cell, a zero byte, and then the number of records as a little-endian
+ * 64-bit integer. The records follow, all of the same size, with no padding in between. A record
+ * holds the n*n cells in row-major order, each one in ceil(log2(n+1)) bits, from the lowest bit of
+ * the first byte up, with the values 1 to n for the known cells and 0 for the unknowns. That is 4
+ * bits per cell, or 41 bytes per record, for a 9*9 board, and the last byte of a record is padded
+ * with zero bits.
+ *
+ * The cells use the same numbering as the cells of a Grid (see Grid::cells()), which is also the
+ * board that the solvers work on, so packing and unpacking are plain bit shuffles. Since every
+ * record has the same size, a memory-mapped file (see MappedFile) can be read at any index with no
+ * parsing at all.
+ **/
+class PackedFormat
+{
+public:
+  /**
+   * @brief The size of the header
+   **/
+  static std::size_t const HEADER_BYTES = 16;
+
+  /**
+   * @brief The number of bits per cell for a board size
+   **/
+  static std::size_t bits(std::size_t n);
+  /**
+   * @brief The size of a record for a board size
+   **/
+  static std::size_t record_bytes(std::size_t n);
+
+  /**
+   * @brief Pack the cells of a board into a record
+   *
+   * @param cells The n*n cells, each between 0 and n.
+   * @param n The side length of the board.
+   * @param record Where to write the record, which has room for record_bytes(n) bytes.
+   **/
+  static void pack(std::uint8_t const* cells, std::size_t n, char* record);
+  /**
+   * @brief Unpack a record into the cells of a board
+   *
+   * @param record The record.
+   * @param n The side length of the board.
+   * @param cells Where to write the n*n cells.
+   * @return bool Whether every cell is between 0 and n. If not, the record is damaged.
+   **/
+  static bool unpack(char const* record, std::size_t n, std::uint8_t* cells);
+  /**
+   * @brief Unpack a record into a grid, which is resized if the record is of another size
+   *
+   * @return bool Whether every cell is between 0 and n.
+   **/
+  static bool unpack(char const* record, std::size_t n, Grid& grid);
+};
+
+/**
+ * @brief Writes a packed file (see PackedFormat) to a stream, a record at a time
+ *
+ * The number of records goes into the header, which is only known once every record has been
+ * written, so finish() has to seek back to the start: the stream has to be a file, not a pipe.
+ **/
+class PackedWriter
+{
+public:
+  /**
+   * @brief Start a file, and write a header with no records
+   *
+   * @param out The stream to write to.
+   * @param n The side length of every board in the file.
+   **/
+  PackedWriter(std::ostream& out, std::size_t n);
+
+  /**
+   * @brief Append a board
+   *
+   * @param grid The board, which has to be of the size of the file.
+   **/
+  void write(Grid const& grid);
+  /**
+   * @brief Append a board given as its n*n cells, each between 0 and n
+   **/
+  void write(std::uint8_t const* cells);
+  /**
+   * @brief Write the number of records into the header
+   *
+   * @return bool Whether the stream took every byte, and could seek back to the header.
+   **/
+  bool finish();
+
+  std::size_t n() const;
+  std::size_t count() const;
+
+private:
+  std::ostream& out;
+  std::size_t dim;
+  std::uint64_t records;
+  std::string record;
+};
+
+/**
+ * @brief The records of a packed file (see PackedFormat) in a buffer, typically a MappedFile
+ **/
+class PackedCorpus
+{
+public:
+  PackedCorpus();
+
+  /**
+   * @brief Whether a buffer starts like a packed file, as opposed to a text one
+   **/
+  static bool detect(char const* data, std::size_t size);
+
+  /**
+   * @brief Check the header of a packed file, and read the records from the buffer from then on
+   *
+   * @param data The buffer, which must outlive the corpus.
+   * @param size The size of the buffer.
+   * @return bool Whether the header is good, and the buffer holds every record. If not, error()
+   *         tells why.
+   **/
+  bool open(char const* data, std::size_t size);
+
+  /**
+   * @brief The side length of the boards
+   **/
+  std::size_t n() const;
+  /**
+   * @brief The number of records
+   **/
+  std::size_t size() const;
+  /**
+   * @brief The packed bytes of a record
+   **/
+  char const* record(std::size_t index) const;
+  /**
+   * @brief Unpack a record into a grid
+   *
+   * @return bool Whether every cell is between 0 and n. If not, the record is damaged.
+   **/
+  bool get(std::size_t index, Grid& grid) const;
+  /**
+   * @brief Unpack a record into n*n cells
+   *
+   * @return bool Whether every cell is between 0 and n. If not, the record is damaged.
+   **/
+  bool get(std::size_t index, std::uint8_t* cells) const;
+
+  /**
+   * @brief Why the last call to open() failed
+   **/
+  std::string const& error() const;
+
+private:
+  char const* records;
+  std::size_t dim, stride, count;
+  std::string message;
+};
+
+#endif // PACKED_H
@@ -0,0 +1,211 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "board.h"
+#include "grid.h"
+#include "solver.h"
+#include "thread_pool.h"
+
+/**
+ * @brief A search of one puzzle spread over the workers of a thread pool
+ *
+ * The search starts as a single task. Whenever a worker runs out of work, the tasks that are still
+ * running notice (see ThreadPool::hungry()) and hand over the untried colors of their shallowest
+ * node, which are the biggest subtrees they have left. Those become new tasks, which idle workers
+ * pick up or steal, and which keep splitting the same way. All the workers stop as soon as the
+ * number of solutions they found between them reaches the limit, so a search for one solution
+ * stops at the first one, and a uniqueness check stops at the second.
+ *
+ * @tparam Geometry The shape of the boards being searched.
+ **/
+template <class Geometry>
+class ParallelSearch : public SearchSplitter<Geometry>
+{
+public:
+  /**
+   * @brief Prepare a search on a pool
+   *
+   * @param pool The workers, which must not be running anything else until run() returns.
+   * @param geometry The shape of the board.
+   **/
+  ParallelSearch(ThreadPool& pool, Geometry const& geometry);
+
+  /**
+   * @brief Search a board
+   *
+   * @param board The Sudoku game board, which is left unchanged.
+   * @param policy The order in which the nodes are colored.
+   * @param limit The number of solutions after which the search gives up.
+   * @param grid If not null, and a solution is found, the first solution found overwrites it.
+   * @param stats If not null, the statistics of all the workers are added to it.
+   * @param watchdog If not null, the limits of the search. The workers count their nodes against
+   *                 the limit together, and the watchdog is tripped if any of them runs out.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  std::size_t run(BasicBoard<Geometry> const& board, Branching policy, std::size_t limit,
+                  Grid* grid, SolveStats* stats = nullptr, Watchdog* watchdog = nullptr);
+
+  bool stopped() const;
+  bool hungry() const;
+  void donate(BasicBoard<Geometry> const& board);
+  bool solution(BasicBoard<Geometry> const& board);
+
+private:
+  ThreadPool& pool;
+  /**
+   * @brief The decision stack of every worker.
+   **/
+  std::vector<std::unique_ptr<BasicSolver<Geometry>>> solvers;
+
+  Branching policy;
+  std::size_t limit;
+  std::atomic<std::size_t> found;
+  std::atomic<bool> stop;
+
+  /**
+   * @brief Where the first solution goes, which only the worker that finds it writes to.
+   **/
+  Grid* grid;
+};
+
+template <class Geometry>
+ParallelSearch<Geometry>::ParallelSearch(ThreadPool& pool, Geometry const& geometry)
+  : pool(pool), policy(Branching::MOST_CONSTRAINED), limit(0), found(0), stop(false),
+    grid(nullptr)
+{
+  for (std::size_t i = 0; i < pool.size(); i++)
+  {
+    this->solvers.emplace_back(new BasicSolver<Geometry>(geometry));
+  }
+}
+
+template <class Geometry>
+std::size_t ParallelSearch<Geometry>::run(BasicBoard<Geometry> const& board, Branching policy,
+                                          std::size_t limit, Grid* grid, SolveStats* stats,
+                                          Watchdog* watchdog)
+{
+  //every worker counts on its own, and the counts are only added up at the end
+  std::vector<SolveStats> parts((stats != nullptr) ? this->solvers.size() : 0);
+  std::vector<Watchdog> watchdogs;
+  std::atomic<std::uint64_t> nodes(0);
+
+  for (std::size_t i = 0; i < parts.size(); i++)
+  {
+    this->solvers[i]->watch(&parts[i]);
+  }
+
+  if (watchdog != nullptr)
+  {
+    //the nodes already spent before the split count too; with no node limit, nothing is shared
+    bool counted = (watchdog->limits().max_nodes != UINT64_MAX);
+    nodes = watchdog->visited();
+    watchdogs.assign(this->solvers.size(),
+                     Watchdog(watchdog->limits(), counted ? &nodes : nullptr));
+
+    for (std::size_t i = 0; i < watchdogs.size(); i++)
+    {
+      this->solvers[i]->guard(&watchdogs[i]);
+    }
+  }
+
+  this->policy = policy;
+  this->limit = limit;
+  this->found = 0;
+  this->stop = (limit == 0);
+  this->grid = grid;
+
+  this->donate(board);
+  this->pool.wait();
+
+  for (std::size_t i = 0; i < parts.size(); i++)
+  {
+    *stats += parts[i];
+    this->solvers[i]->watch(nullptr);
+  }
+
+  for (std::size_t i = 0; i < watchdogs.size(); i++)
+  {
+    if (watchdogs[i].tripped())
+    {
+      watchdog->trip();
+    }
+
+    this->solvers[i]->guard(nullptr);
+  }
+
+  //workers that found a solution at the same time may have overshot the limit
+  return std::min<std::size_t>(this->found, limit);
+}
+
+template <class Geometry>
+bool ParallelSearch<Geometry>::stopped() const
+{
+  return this->stop.load(std::memory_order_relaxed);
+}
+
+template <class Geometry>
+bool ParallelSearch<Geometry>::hungry() const
+{
+  return this->pool.hungry();
+}
+
+template <class Geometry>
+void ParallelSearch<Geometry>::donate(BasicBoard<Geometry> const& board)
+{
+  std::shared_ptr<BasicBoard<Geometry>> subtree(new BasicBoard<Geometry>(board));
+
+  this->pool.submit([this, subtree](std::size_t worker)
+  {
+    this->solvers[worker]->share(*subtree, this->policy, *this);
+
+    //a worker that ran out of time or nodes stops the others too
+    if (this->solvers[worker]->expired())
+    {
+      this->stop = true;
+    }
+  });
+}
+
+template <class Geometry>
+bool ParallelSearch<Geometry>::solution(BasicBoard<Geometry> const& board)
+{
+  std::size_t count = ++this->found;
+
+  if (count == 1 && this->grid != nullptr)
+  {
+    board.store(*this->grid);
+  }
+
+  if (count >= this->limit)
+  {
+    this->stop = true;
+  }
+
+  return !this->stop;
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,576 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+  inline bool is_space(char c)
+  {
+    return c == ' ' || c == '\t' || c == '\r';
+  }
+
+  /**
+   * @brief The newline at the end of a line, or the end of the buffer if the line has none
+   **/
+  inline char const* line_end(char const* p, char const* end)
+  {
+    char const* eol = static_cast<char const*>(std::memchr(p, '\n', end - p));
+    return (eol == nullptr) ? end : eol;
+  }
+
+  /**
+   * @brief The start of the line after a line
+   **/
+  inline char const* after_line(char const* eol, char const* end)
+  {
+    return (eol == end) ? end : eol + 1;
+  }
+
+  /**
+   * @brief The number of values on a line: zero for a blank line, one for a puzzle in the single
+   *        line format, and n for a row of a grid
+   **/
+  std::size_t count_tokens(char const* p, char const* eol)
+  {
+    std::size_t tokens = 0;
+    bool inside = false;
+
+    for (; p != eol; p++)
+    {
+      bool space = is_space(*p);
+      tokens += (!space && !inside);
+      inside = !space;
+    }
+
+    return tokens;
+  }
+
+  /**
+   * @brief Whether n is the side length of a Sudoku board, i.e., a perfect square
+   **/
+  bool is_board_size(std::size_t n)
+  {
+    std::size_t root = 1;
+
+    while (root * root < n)
+    {
+      root++;
+    }
+
+    return root * root == n;
+  }
+
+  /**
+   * @brief The side length of the board held by a line of values separated by spaces, or 0 if the
+   *        line is a row of a grid. A line holds a whole board when it has more values than the
+   *        longest row, which is how boards over 25*25 are written on a single line (see
+   *        Layout::COMPACT).
+   **/
+  std::size_t line_board_size(std::size_t tokens)
+  {
+    std::size_t n = 1;
+
+    while (tokens > Grid::MAX_N && n * n < tokens)
+    {
+      n++;
+    }
+
+    return (tokens > Grid::MAX_N && n * n == tokens && is_board_size(n)) ? n : 0;
+  }
+
+  /**
+   * @brief Whether a line is a row of a grid, rather than a blank line or a whole puzzle
+   **/
+  inline bool is_row(std::size_t tokens)
+  {
+    return tokens > 1 && line_board_size(tokens) == 0;
+  }
+}
+
+MappedFile::MappedFile() : bytes(nullptr), length(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+  this->close();
+}
+
+bool MappedFile::open(std::string const& path)
+{
+  int fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd == -1)
+  {
+    this->close();
+    this->message = path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  bool mapped = this->map(fd);
+  ::close(fd);
+
+  if (!mapped)
+  {
+    this->message = path + ": " + this->message;
+  }
+
+  return mapped;
+}
+
+bool MappedFile::map(int fd)
+{
+  struct stat info;
+
+  this->close();
+
+  if (fstat(fd, &info) == -1)
+  {
+    this->message = std::strerror(errno);
+    return false;
+  }
+
+  if (!S_ISREG(info.st_mode))
+  {
+    this->message = "not a regular file";
+    return false;
+  }
+
+  //an empty file cannot be mapped, but there is nothing to read from it anyway
+  if (info.st_size == 0)
+  {
+    return true;
+  }
+
+  void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if (address == MAP_FAILED)
+  {
+    this->message = std::strerror(errno);
+    return false;
+  }
+
+  //the puzzles are read front to back, so let the kernel read ahead aggressively
+  madvise(address, info.st_size, MADV_SEQUENTIAL);
+
+  this->bytes = static_cast<char const*>(address);
+  this->length = info.st_size;
+  return true;
+}
+
+void MappedFile::close()
+{
+  if (this->bytes != nullptr)
+  {
+    munmap(const_cast<char*>(this->bytes), this->length);
+  }
+
+  this->bytes = nullptr;
+  this->length = 0;
+}
+
+char const* MappedFile::data() const
+{
+  return this->bytes;
+}
+
+std::size_t MappedFile::size() const
+{
+  return this->length;
+}
+
+std::string const& MappedFile::error() const
+{
+  return this->message;
+}
+
+PuzzleReader::PuzzleReader(char const* data, std::size_t size, std::size_t base)
+  : begin(data), cursor(data), end(data + size), base(base), error(false), error_at(0),
+    error_text("")
+{
+}
+
+bool PuzzleReader::done()
+{
+  while (this->cursor != this->end)
+  {
+    char const* eol = line_end(this->cursor, this->end);
+
+    if (count_tokens(this->cursor, eol) != 0)
+    {
+      return false;
+    }
+
+    this->cursor = after_line(eol, this->end);
+  }
+
+  return true;
+}
+
+bool PuzzleReader::next(Grid& grid)
+{
+  this->error = false;
+
+  if (this->done())
+  {
+    return this->fail(this->cursor, "there are no puzzles left", false);
+  }
+
+  //a single value or a whole board of values on the first line is a puzzle, otherwise it is the
+  //first row of a grid
+  char const* eol = line_end(this->cursor, this->end);
+  std::size_t tokens = count_tokens(this->cursor, eol);
+
+  if (tokens == 1)
+  {
+    return this->next_line(grid, eol);
+  }
+  else if (std::size_t n = line_board_size(tokens))
+  {
+    return this->next_grid(grid, n, 1);
+  }
+  else
+  {
+    return this->next_grid(grid, tokens, tokens);
+  }
+}
+
+bool PuzzleReader::next_line(Grid& grid, char const* eol)
+{
+  char const* first = this->cursor;
+  char const* last = eol;
+
+  while (is_space(*first))
+  {
+    first++;
+  }
+
+  while (is_space(last[-1]))
+  {
+    last--;
+  }
+
+  std::size_t length = last - first, n = 1;
+
+  while (n * n < length)
+  {
+    n++;
+  }
+
+  //one character per cell only goes up to 'P', which is 25
+  if (n * n != length || !is_board_size(n) || n > 25)
+  {
+    return this->fail(first, "the line does not hold a square board of up to 25*25 cells", false);
+  }
+
+  if (grid.n() != n)
+  {
+    grid.reset(n);
+  }
+
+  for (std::size_t cell = 0; cell < length; cell++)
+  {
+    char c = first[cell];
+    int value;
+
+    if (c == '.' || c == '0')
+    {
+      value = -1;
+    }
+    else if (c >= '1' && c <= '9')
+    {
+      value = c - '0';
+    }
+    else if (c >= 'A' && c <= 'Z')
+    {
+      value = c - 'A' + 10;
+    }
+    else if (c >= 'a' && c <= 'z')
+    {
+      value = c - 'a' + 10;
+    }
+    else
+    {
+      return this->fail(first + cell, "invalid character in board", false);
+    }
+
+    if (value > (int)n)
+    {
+      return this->fail(first + cell, "value out of range", false);
+    }
+
+    grid.set(cell % n, cell / n, value);
+  }
+
+  this->cursor = after_line(eol, this->end);
+  return true;
+}
+
+bool PuzzleReader::next_grid(Grid& grid, std::size_t n, std::size_t lines)
+{
+  //the values of a line go on to the next rows of the board when there is only one line
+  const std::size_t width = n * n / lines;
+  const bool rows = (lines != 1);
+
+  if (!is_board_size(n))
+  {
+    return this->fail(this->cursor, "the number of values in a row is not a perfect square", rows);
+  }
+
+  if (n > Grid::MAX_N)
+  {
+    //the board cannot be solved with this program
+    return this->fail(this->cursor, "the board is bigger than 144*144", rows);
+  }
+
+  if (grid.n() != n)
+  {
+    grid.reset(n);
+  }
+
+  for (std::size_t line = 0; line < lines; line++)
+  {
+    if (this->cursor == this->end)
+    {
+      return this->fail(this->cursor, "the board ends early", rows);
+    }
+
+    char const* p = this->cursor;
+    char const* eol = line_end(p, this->end);
+
+    for (std::size_t cell = line * width; cell < (line + 1) * width; cell++)
+    {
+      while (p != eol && is_space(*p))
+      {
+        p++;
+      }
+
+      if (p == eol)
+      {
+        return this->fail(p, "the row has too few values", rows);
+      }
+
+      char const* token = p;
+      int value = 0;
+
+      if (*p == '?' || *p == '.')
+      {
+        value = -1;
+        p++;
+      }
+      else
+      {
+        for (; p != eol && *p >= '0' && *p <= '9'; p++)
+        {
+          //stop accumulating once the value is out of range, so that it cannot overflow
+          value = (value > (int)n) ? value : value * 10 + (*p - '0');
+        }
+
+        if (p == token)
+        {
+          return this->fail(token, "invalid character in board", rows);
+        }
+
+        //integer values must be between 1 and n
+        if (value < 1 || value > (int)n)
+        {
+          return this->fail(token, "value out of range", rows);
+        }
+      }
+
+      if (p != eol && !is_space(*p))
+      {
+        return this->fail(p, "invalid character in board", rows);
+      }
+
+      grid.set(cell % n, cell / n, value);
+    }
+
+    while (p != eol && is_space(*p))
+    {
+      p++;
+    }
+
+    if (p != eol)
+    {
+      return this->fail(p, "the row has too many values", rows);
+    }
+
+    this->cursor = after_line(eol, this->end);
+  }
+
+  return true;
+}
+
+bool PuzzleReader::fail(char const* at, char const* message, bool grid)
+{
+  this->error = true;
+  this->error_at = this->base + (at - this->begin);
+  this->error_text = message;
+
+  //skip the line with the problem, and the rest of the grid it belongs to
+  this->cursor = after_line(line_end(this->cursor, this->end), this->end);
+
+  while (grid && this->cursor != this->end)
+  {
+    char const* eol = line_end(this->cursor, this->end);
+
+    if (!is_row(count_tokens(this->cursor, eol)))
+    {
+      break;
+    }
+
+    this->cursor = after_line(eol, this->end);
+  }
+
+  return false;
+}
+
+PuzzleReader PuzzleReader::split(std::size_t bytes)
+{
+  char const* start = this->cursor;
+  char const* p = (std::size_t(this->end - start) <= bytes) ? this->end : start + bytes;
+
+  if (p != this->end)
+  {
+    //go back to the start of the line, but take at least one line
+    while (p != start && p[-1] != '\n')
+    {
+      p--;
+    }
+
+    if (p == start)
+    {
+      p = after_line(line_end(p, this->end), this->end);
+    }
+
+    //the line before ends with the newline at p - 1
+    char const* previous = p - 1;
+
+    while (previous != start && previous[-1] != '\n')
+    {
+      previous--;
+    }
+
+    bool before = is_row(count_tokens(previous, p - 1));
+
+    //a puzzle starts on a line that is not a grid row, or on the first line after one
+    while (p != this->end)
+    {
+      char const* eol = line_end(p, this->end);
+      bool row = is_row(count_tokens(p, eol));
+
+      if (!row || !before)
+      {
+        break;
+      }
+
+      before = row;
+      p = after_line(eol, this->end);
+    }
+  }
+
+  PuzzleReader part(start, p - start, this->offset());
+  this->cursor = p;
+  return part;
+}
+
+std::size_t PuzzleReader::complete(char const* data, std::size_t size)
+{
+  char const* end = data + size;
+  char const* boundary = data;
+  bool before = false;
+
+  //only lines that end with a newline are known to be complete
+  for (char const* p = data; p != end;)
+  {
+    char const* eol = line_end(p, end);
+
+    if (eol == end)
+    {
+      break;
+    }
+
+    bool row = is_row(count_tokens(p, eol));
+
+    if (!row || !before)
+    {
+      boundary = p;
+    }
+
+    before = row;
+    p = eol + 1;
+  }
+
+  return boundary - data;
+}
+
+bool PuzzleReader::read(std::istream& in, std::string& text)
+{
+  std::string line;
+
+  do
+  {
+    if (!std::getline(in, line))
+    {
+      return false;
+    }
+  }
+  while (count_tokens(line.data(), line.data() + line.size()) == 0);
+
+  //the first row of a grid tells how many more rows to read
+  std::size_t tokens = count_tokens(line.data(), line.data() + line.size());
+  std::size_t n = is_row(tokens) ? tokens : 1;
+  text = line;
+
+  for (std::size_t y = 1; y < n && std::getline(in, line); y++)
+  {
+    text += '\n';
+    text += line;
+  }
+
+  return true;
+}
+
+std::size_t PuzzleReader::offset() const
+{
+  return this->base + (this->cursor - this->begin);
+}
+
+bool PuzzleReader::failed() const
+{
+  return this->error;
+}
+
+std::size_t PuzzleReader::error_offset() const
+{
+  return this->error_at;
+}
+
+char const* PuzzleReader::error_message() const
+{
+  return this->error_text;
+}
@@ -0,0 +1,193 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef READER_H
+#define READER_H
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+#include "grid.h"
+
+/**
+ * @brief A file mapped into memory, read-only
+ *
+ * The pages of the file are only read in as they are touched, and the kernel is told that they
+ * will be read in order, so a large corpus of puzzles can be parsed straight from the page cache
+ * without copying it into a buffer first.
+ **/
+class MappedFile
+{
+public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(MappedFile const&) = delete;
+  MappedFile& operator =(MappedFile const&) = delete;
+
+  /**
+   * @brief Map a file, replacing whatever was mapped before
+   *
+   * @param path The path of the file.
+   * @return bool Whether the file could be mapped. If not, error() tells why.
+   **/
+  bool open(std::string const& path);
+  /**
+   * @brief Map a file that is already open, such as standard input when it is redirected from a
+   *        file. Pipes and terminals cannot be mapped.
+   *
+   * @param fd The file descriptor, which stays open.
+   * @return bool Whether the file could be mapped. If not, error() tells why.
+   **/
+  bool map(int fd);
+  /**
+   * @brief Unmap the file, if any
+   **/
+  void close();
+
+  char const* data() const;
+  std::size_t size() const;
+  /**
+   * @brief Why the last call to open() or map() failed
+   **/
+  std::string const& error() const;
+
+private:
+  char const* bytes;
+  std::size_t length;
+  std::string message;
+};
+
+/**
+ * @brief A cursor over a buffer of puzzles, which parses them straight into grids
+ *
+ * The buffer holds puzzles in either of the formats that the Sudoku class reads: a grid of n lines
+ * of n values separated by spaces, with '?' (or '.') for the unknowns, or a single line of n*n
+ * characters, with '1'-'9' and 'A'-'P' for the values and '.' or '0' for the unknowns. Boards over
+ * 25*25 can also be on a single line of n*n values separated by spaces, which is told apart from a
+ * row of a grid by having more values than any row. Blank lines between puzzles are skipped, and
+ * the formats can be mixed.
+ *
+ * Parsing never allocates (unless the grid has to change size) and never throws: a malformed
+ * puzzle is skipped, and the reader remembers what was wrong with it and at which byte offset. The
+ * reader does not own the buffer, which is typically a MappedFile, so it is cheap to copy, and a
+ * buffer can be cut into parts (see split()) that are parsed on different threads.
+ **/
+class PuzzleReader
+{
+public:
+  /**
+   * @brief Read puzzles from a buffer
+   *
+   * @param data The buffer, which must outlive the reader.
+   * @param size The size of the buffer.
+   * @param base The offset of the buffer in its file, which is added to the error offsets.
+   **/
+  PuzzleReader(char const* data, std::size_t size, std::size_t base = 0);
+
+  /**
+   * @brief Skip the blank lines before the next puzzle, and tell whether there is one
+   *
+   * @return bool Whether every puzzle has been read.
+   **/
+  bool done();
+  /**
+   * @brief Parse the next puzzle
+   *
+   * @param grid The grid to fill in, which is resized if the puzzle is of another size.
+   * @return bool Whether the puzzle was well-formed. If it was not, the reader has moved past it,
+   *         and error_offset() and error_message() tell what was wrong.
+   **/
+  bool next(Grid& grid);
+  /**
+   * @brief Cut the puzzles at the front of the buffer off into a reader of their own
+   *
+   * @param bytes Roughly how much of the buffer to take: the part ends on the first puzzle
+   *              boundary after that many bytes.
+   * @return PuzzleReader A reader over the part, which this reader then skips.
+   **/
+  PuzzleReader split(std::size_t bytes);
+  /**
+   * @brief The length of the longest prefix of a buffer that holds only whole puzzles, assuming
+   *        that more data may follow the buffer
+   *
+   * @param data The buffer.
+   * @param size The size of the buffer.
+   * @return std::size_t The length of the prefix, which may be zero.
+   **/
+  static std::size_t complete(char const* data, std::size_t size);
+  /**
+   * @brief Read the lines of the next puzzle from a stream, for when the puzzles do not come from a
+   *        buffer: either one line of n*n cells or values or a grid of n lines, skipping the blank
+   *        lines in between. The lines are not checked, which is left to next().
+   *
+   * @param in The stream of puzzles.
+   * @param text Set to the lines of the puzzle.
+   * @return bool Whether there was another puzzle in the stream.
+   **/
+  static bool read(std::istream& in, std::string& text);
+
+  /**
+   * @brief The offset of the cursor in the file
+   **/
+  std::size_t offset() const;
+  /**
+   * @brief Whether the last call to next() failed
+   **/
+  bool failed() const;
+  /**
+   * @brief The offset in the file of the problem found by the last call to next() that failed
+   **/
+  std::size_t error_offset() const;
+  /**
+   * @brief A description of the problem found by the last call to next() that failed
+   **/
+  char const* error_message() const;
+
+private:
+  /**
+   * @brief Parse a puzzle in the single line format
+   **/
+  bool next_line(Grid& grid, char const* eol);
+  /**
+   * @brief Parse a puzzle of values separated by spaces, either in the grid format (n lines) or
+   *        all on one line
+   **/
+  bool next_grid(Grid& grid, std::size_t n, std::size_t lines);
+  /**
+   * @brief Record a problem, and skip the rest of the puzzle
+   *
+   * @param at Where the problem is.
+   * @param message What the problem is.
+   * @param grid Whether the puzzle is a grid, which runs to the next blank line.
+   * @return bool Always false.
+   **/
+  bool fail(char const* at, char const* message, bool grid);
+
+  char const* begin;
+  char const* cursor;
+  char const* end;
+  std::size_t base;
+
+  bool error;
+  std::size_t error_at;
+  char const* error_text;
+};
+
+#endif // READER_H
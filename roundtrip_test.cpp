@@ -0,0 +1,253 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "batch.h"
+#include "serializer.h"
+#include "sudoku.h"
+
+namespace
+{
+  std::size_t failures = 0;
+
+  void check(bool ok, char const* what)
+  {
+    if (!ok)
+    {
+      std::cerr << "FAILED: " << what << std::endl;
+      failures++;
+    }
+  }
+
+  /**
+   * @brief A n*n puzzle made from the standard pattern solution, with every k-th cell unknown
+   **/
+  Grid make_puzzle(std::size_t n, std::size_t k)
+  {
+    std::size_t b = 1;
+    Grid grid(n);
+
+    while (b * b < n)
+    {
+      b++;
+    }
+
+    for (std::size_t y = 0; y < n; y++)
+    {
+      for (std::size_t x = 0; x < n; x++)
+      {
+        int value = int((b * (y % b) + y / b + x) % n + 1);
+        grid.set(x, y, ((y * n + x) % k == 0) ? -1 : value);
+      }
+    }
+
+    return grid;
+  }
+
+  bool same(Grid const& a, Grid const& b)
+  {
+    return a.n() == b.n() && std::memcmp(a.cells(), b.cells(), a.n() * a.n()) == 0;
+  }
+
+  /**
+   * @brief The current state of a puzzle, read back from its compact layout
+   **/
+  Grid board_of(Sudoku const& sudoku)
+  {
+    std::string line(sudoku.size(Layout::COMPACT), '\0');
+    sudoku.write(&line[0], line.size(), Layout::COMPACT);
+
+    Grid grid(0);
+    PuzzleReader reader(line.data(), line.size());
+    reader.next(grid);
+    return grid;
+  }
+
+  /**
+   * @brief Write a board in the compact layout and read it back
+   **/
+  void test_line(std::size_t n)
+  {
+    Grid puzzle = make_puzzle(n, 7);
+    std::string line(Serializer::size(puzzle, Layout::COMPACT), '\0');
+    Serializer::write(puzzle, Layout::COMPACT, &line[0], line.size());
+
+    check(line.find('\n') == std::string::npos, "a compact board is written on one line");
+
+    Grid grid(0);
+    PuzzleReader reader(line.data(), line.size());
+    check(reader.next(grid), "a compact board can be read back");
+    check(same(grid, puzzle), "a compact board reads back as the same board");
+    check(reader.done(), "a compact board is read as a single puzzle");
+
+    std::istringstream in(line + "\n" + line + "\n");
+    std::string text;
+    check(PuzzleReader::read(in, text) && text == line, "a stream yields a compact board whole");
+  }
+
+  /**
+   * @brief Solve a batch, and then solve its own output again, which has to come back unchanged
+   **/
+  void test_batch(std::size_t n)
+  {
+    Grid puzzle = make_puzzle(n, 5);
+    std::string text;
+
+    for (int i = 0; i < 3; i++)
+    {
+      std::string line(Serializer::size(puzzle, Layout::COMPACT), '\0');
+      Serializer::write(puzzle, Layout::COMPACT, &line[0], line.size());
+      text += line + "\n";
+    }
+
+    BatchSolver solver(1);
+    std::istringstream first_in(text);
+    std::ostringstream first_out;
+    BatchSolver::Summary first = solver.solve(first_in, first_out);
+    check(first.total == 3 && first.solved == 3, "a batch of compact boards is solved");
+
+    std::istringstream second_in(first_out.str());
+    std::ostringstream second_out;
+    BatchSolver::Summary second = solver.solve(second_in, second_out);
+    check(second.total == 3 && second.solved == 3, "the solutions of a batch can be read back");
+    check(second_out.str() == first_out.str(), "the solutions of a batch are stable");
+
+    Sudoku sudoku;
+    std::string line = first_out.str().substr(0, first_out.str().find('\n'));
+    check(sudoku.read_puzzle_from_line(line) && sudoku.solved(),
+          "a solution of a batch is read by read_puzzle_from_line()");
+  }
+
+  /**
+   * @brief Solve a puzzle through a cache, and then a transposed and relabeled copy of it, which
+   *        has to be answered from the cache with the matching solution
+   **/
+  void test_cache(std::size_t n)
+  {
+    SolutionCache cache(16);
+    Grid puzzle = make_puzzle(n, 7), copy(n);
+
+    for (std::size_t y = 0; y < n; y++)
+    {
+      for (std::size_t x = 0; x < n; x++)
+      {
+        int value = puzzle.get(y, x);
+        copy.set(x, y, (value == -1) ? -1 : int(n) + 1 - value);
+      }
+    }
+
+    Sudoku first, second;
+    first.use_cache(&cache);
+    second.use_cache(&cache);
+
+    check(first.read_puzzle_from_grid(puzzle) &&
+          first.solve_dsatur_style() == SolveResult::SOLVED, "a big board is solved");
+    check(second.read_puzzle_from_grid(copy) &&
+          second.solve_dsatur_style() == SolveResult::SOLVED, "a big board is solved from a cache");
+    check(cache.metrics().hits == 1, "a transformed big board is found in a cache");
+
+    Grid solution = board_of(first), cached = board_of(second);
+    bool matches = (cached.n() == n);
+
+    for (std::size_t y = 0; matches && y < n; y++)
+    {
+      for (std::size_t x = 0; matches && x < n; x++)
+      {
+        matches = (cached.get(x, y) == int(n) + 1 - solution.get(y, x));
+      }
+    }
+
+    check(matches, "a big board from a cache gets the transformed solution");
+  }
+
+  /**
+   * @brief Fill in the pencil marks of an empty board and of a nearly full one, whose candidates
+   *        have to come back in masks as wide as the board
+   **/
+  void test_marks(std::size_t n)
+  {
+    Sudoku sudoku;
+    Grid marks(0);
+    check(sudoku.read_puzzle_from_grid(Grid(n)) && sudoku.pencil_marks(marks) &&
+          marks.has_candidates() && marks.candidate_words() == (n + 63) / 64,
+          "an empty board gets pencil marks");
+
+    bool open = true;
+
+    for (int i = 1; i <= int(n); i++)
+    {
+      open = open && marks.is_candidate(n - 1, n - 1, i);
+    }
+
+    check(open && marks.get(n - 1, n - 1) == -1, "every value fits a cell of an empty board");
+
+    Grid puzzle = make_puzzle(n, 7);
+    check(sudoku.read_puzzle_from_grid(puzzle) && sudoku.pencil_marks(marks),
+          "a nearly full board gets pencil marks");
+    check(same(board_of(sudoku), puzzle), "pencil marks leave the board unchanged");
+
+    bool forced = true;
+
+    for (std::size_t y = 0; y < n; y++)
+    {
+      for (std::size_t x = 0; x < n; x++)
+      {
+        int value = marks.get(x, y);
+        std::size_t count = 0;
+
+        for (std::size_t w = 0; w < marks.candidate_words(); w++)
+        {
+          count += __builtin_popcountll(marks.candidates(x, y)[w]);
+        }
+
+        forced = forced && value != -1 && count == 1 && marks.is_candidate(x, y, value);
+      }
+    }
+
+    check(forced, "the pencil marks of a nearly full board are its solution");
+  }
+}
+
+int main()
+{
+  for (std::size_t n : {9, 25, 36, 49})
+  {
+    test_line(n);
+  }
+
+  test_batch(9);
+  test_batch(36);
+  test_cache(9);
+  test_cache(81);
+  test_cache(144);
+  test_marks(9);
+  test_marks(144);
+
+  if (failures != 0)
+  {
+    std::cerr << failures << " checks failed" << std::endl;
+    return 1;
+  }
+
+  std::cout << "all checks passed" << std::endl;
+  return 0;
+}
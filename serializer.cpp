@@ -0,0 +1,163 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "serializer.h"
+
+namespace
+{
+  /**
+   * @brief The character for every value in the compact layout, and the digits of every value in
+   *        the spaced layout, indexed by the raw value of a cell (so the unknown value is at 0)
+   **/
+  struct Digits
+  {
+    char compact[Grid::MAX_N + 1];
+    char spaced[Grid::MAX_N + 1][3];
+    unsigned char width[Grid::MAX_N + 1];
+
+    Digits()
+    {
+      compact[0] = '.';
+      spaced[0][0] = '?';
+      width[0] = 1;
+
+      for (int i = 1; i <= int(Grid::MAX_N); i++)
+      {
+        compact[i] = (i <= 9) ? char('0' + i) : char('A' + i - 10);
+        width[i] = (i <= 9) ? 1 : (i <= 99) ? 2 : 3;
+
+        //the digits are written from the last one back
+        for (int k = width[i] - 1, value = i; k >= 0; k--, value /= 10)
+        {
+          spaced[i][k] = char('0' + value % 10);
+        }
+      }
+    }
+  };
+
+  Digits const digits;
+
+  /**
+   * @brief The longest row the serializer writes: 144 values of three digits, with separators
+   **/
+  std::size_t const MAX_ROW = Grid::MAX_N * 4 + 1;
+
+  inline bool is_compact(Grid const& grid, Layout layout)
+  {
+    return layout == Layout::COMPACT && grid.n() <= 25;
+  }
+}
+
+std::size_t Serializer::size(Grid const& grid, Layout layout)
+{
+  const std::size_t n = grid.n();
+
+  if (is_compact(grid, layout))
+  {
+    return n * n;
+  }
+
+  //one separator between every two values, whether it is a space or a newline
+  std::size_t size = (n * n == 0) ? 0 : n * n - 1;
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      size += digits.width[grid.cell(x, y)];
+    }
+  }
+
+  return size;
+}
+
+char* Serializer::write_row(Grid const& grid, Layout layout, std::size_t y, char* p)
+{
+  const std::size_t n = grid.n();
+
+  if (is_compact(grid, layout))
+  {
+    for (std::size_t x = 0; x < n; x++)
+    {
+      *p++ = digits.compact[grid.cell(x, y)];
+    }
+
+    return p;
+  }
+
+  for (std::size_t x = 0; x < n; x++)
+  {
+    int i = grid.cell(x, y);
+
+    if (x != 0)
+    {
+      *p++ = ' ';
+    }
+    else if (y != 0)
+    {
+      *p++ = (layout == Layout::SPACED) ? '\n' : ' ';
+    }
+
+    for (int k = 0; k < digits.width[i]; k++)
+    {
+      *p++ = digits.spaced[i][k];
+    }
+  }
+
+  return p;
+}
+
+std::size_t Serializer::write(Grid const& grid, Layout layout, char* buffer, std::size_t capacity)
+{
+  const std::size_t n = grid.n();
+
+  if (size(grid, layout) > capacity)
+  {
+    return 0;
+  }
+
+  char* p = buffer;
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    p = write_row(grid, layout, y, p);
+  }
+
+  return p - buffer;
+}
+
+void Serializer::write(Grid const& grid, Layout layout, std::ostream& out)
+{
+  const std::size_t n = grid.n();
+  char buffer[4096];
+  char* p = buffer;
+
+  for (std::size_t y = 0; y < n; y++)
+  {
+    //make room for the next row by handing the buffer over to the stream
+    if (std::size_t(buffer + sizeof(buffer) - p) < MAX_ROW)
+    {
+      out.write(buffer, p - buffer);
+      p = buffer;
+    }
+
+    p = write_row(grid, layout, y, p);
+  }
+
+  out.write(buffer, p - buffer);
+}
@@ -0,0 +1,93 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERIALIZER_H
+#define SERIALIZER_H
+
+#include <cstddef>
+#include <ostream>
+
+#include "grid.h"
+
+/**
+ * @brief The text layouts a board can be written in
+ **/
+enum class Layout
+{
+  /**
+   * @brief One line per row, with the values separated by spaces and '?' for the unknowns, as read
+   *        by Sudoku::read_puzzle_from_file(). There is no newline after the last row.
+   **/
+  SPACED,
+  /**
+   * @brief The whole board on one line, with one character per cell ('1'-'9', then 'A'-'P') and '.'
+   *        for the unknowns, as read by Sudoku::read_puzzle_from_line(). Boards over 25*25 do not
+   *        fit in one character per cell, so they are written as one line of values separated by
+   *        spaces instead, which the reader tells apart from a row of a grid by its length.
+   *        There is no newline at the end.
+   **/
+  COMPACT
+};
+
+/**
+ * @brief Writes boards as text without allocating
+ *
+ * A board can be written into a buffer that the caller provides, whose size can be known ahead of
+ * time, or into an output stream, in which case it goes through a small buffer on the stack. Every
+ * cell is written with a couple of table lookups, and nothing is flushed.
+ **/
+class Serializer
+{
+public:
+  /**
+   * @brief The number of characters it takes to write a board
+   *
+   * @param grid The Sudoku board.
+   * @param layout The layout to write it in.
+   * @return std::size_t The number of characters.
+   **/
+  static std::size_t size(Grid const& grid, Layout layout);
+  /**
+   * @brief Write a board into a buffer
+   *
+   * @param grid The Sudoku board.
+   * @param layout The layout to write it in.
+   * @param buffer Where to write the board. Nothing is written if it is too small.
+   * @param capacity The size of the buffer.
+   * @return std::size_t The number of characters written, or 0 if the buffer is too small.
+   **/
+  static std::size_t write(Grid const& grid, Layout layout, char* buffer, std::size_t capacity);
+  /**
+   * @brief Write a board into an output stream
+   *
+   * @param grid The Sudoku board.
+   * @param layout The layout to write it in.
+   * @param out The output stream, which is not flushed.
+   **/
+  static void write(Grid const& grid, Layout layout, std::ostream& out);
+
+private:
+  /**
+   * @brief Write one row of a board, with the separator that goes before it
+   *
+   * @return char* Where the row ends.
+   **/
+  static char* write_row(Grid const& grid, Layout layout, std::size_t y, char* p);
+};
+
+#endif // SERIALIZER_H
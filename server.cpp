@@ -0,0 +1,417 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+  /**
+   * @brief The sizes of the fixed fields of the frames
+   **/
+  std::size_t const LENGTH_BYTES = 4, ID_BYTES = 4, REQUEST_HEADER = 9, RESPONSE_HEADER = 5;
+  /**
+   * @brief The number of requests of a connection in flight per worker, before the server stops
+   *        reading more
+   **/
+  std::size_t const REQUESTS_PER_WORKER = 64;
+
+  std::uint32_t get_u32(char const* bytes)
+  {
+    unsigned char const* b = reinterpret_cast<unsigned char const*>(bytes);
+    return (std::uint32_t(b[0]) << 24) | (std::uint32_t(b[1]) << 16) |
+           (std::uint32_t(b[2]) << 8) | std::uint32_t(b[3]);
+  }
+
+  void put_u32(char* bytes, std::uint32_t value)
+  {
+    bytes[0] = char(value >> 24);
+    bytes[1] = char(value >> 16);
+    bytes[2] = char(value >> 8);
+    bytes[3] = char(value);
+  }
+
+  /**
+   * @brief Read exactly some number of bytes, unless the stream ends or fails first
+   **/
+  bool read_fully(int fd, char* buffer, std::size_t size)
+  {
+    while (size > 0)
+    {
+      ssize_t count = ::read(fd, buffer, size);
+
+      if (count <= 0)
+      {
+        if (count == -1 && errno == EINTR)
+        {
+          continue;
+        }
+
+        return false;
+      }
+
+      buffer += count;
+      size -= count;
+    }
+
+    return true;
+  }
+
+  bool write_fully(int fd, char const* buffer, std::size_t size)
+  {
+    while (size > 0)
+    {
+      ssize_t count = ::write(fd, buffer, size);
+
+      if (count <= 0)
+      {
+        if (count == -1 && errno == EINTR)
+        {
+          continue;
+        }
+
+        return false;
+      }
+
+      buffer += count;
+      size -= count;
+    }
+
+    return true;
+  }
+
+  bool skip(int fd, std::size_t size)
+  {
+    char block[4096];
+
+    while (size > 0)
+    {
+      std::size_t count = std::min(size, sizeof(block));
+
+      if (!read_fully(fd, block, count))
+      {
+        return false;
+      }
+
+      size -= count;
+    }
+
+    return true;
+  }
+}
+
+Server::Summary::Summary() : total(0), ok(0), unsolvable(0), aborted(0), invalid(0), bad(0)
+{
+}
+
+Server::Connection::Connection(int out) : out(out), in_flight(0), closed(false)
+{
+}
+
+Server::Server(std::size_t threads, std::size_t cache)
+  : solutions(cache), pool(threads), sudokus(pool.size()), replies(pool.size())
+{
+  if (cache > 0)
+  {
+    for (Sudoku& sudoku : this->sudokus)
+    {
+      sudoku.use_cache(&this->solutions);
+    }
+  }
+}
+
+std::size_t Server::threads() const
+{
+  return this->pool.size();
+}
+
+SolutionCache::Metrics Server::cache_metrics() const
+{
+  return this->solutions.metrics();
+}
+
+std::string const& Server::error() const
+{
+  return this->message;
+}
+
+Server::Summary Server::serve(int in, int out)
+{
+  Connection connection(out);
+  std::size_t const window = REQUESTS_PER_WORKER * this->pool.size();
+  char header[LENGTH_BYTES];
+
+  while (!connection.closed && read_fully(in, header, LENGTH_BYTES))
+  {
+    std::uint32_t length = get_u32(header);
+
+    if (length > MAX_FRAME)
+    {
+      //keep the id, so that the client knows which request was refused, and drop the rest
+      std::string frame(LENGTH_BYTES + RESPONSE_HEADER, '\0');
+
+      if (!read_fully(in, &frame[LENGTH_BYTES], ID_BYTES) || !skip(in, length - ID_BYTES))
+      {
+        break;
+      }
+
+      frame += "the request is too large";
+      respond(connection, get_u32(&frame[LENGTH_BYTES]), BAD_REQUEST, frame);
+      continue;
+    }
+
+    std::shared_ptr<std::string> request = std::make_shared<std::string>(length, '\0');
+
+    if (!read_fully(in, &(*request)[0], length))
+    {
+      break;
+    }
+
+    {
+      std::unique_lock<std::mutex> guard(connection.lock);
+
+      while (connection.in_flight >= window)
+      {
+        connection.done.wait(guard);
+      }
+
+      connection.in_flight++;
+    }
+
+    this->pool.submit([this, &connection, request](std::size_t worker)
+    {
+      this->answer(connection, *request, worker);
+
+      //signal while holding the lock, since the connection is gone as soon as the reader wakes
+      std::lock_guard<std::mutex> guard(connection.lock);
+      connection.in_flight--;
+      connection.done.notify_all();
+    });
+  }
+
+  std::unique_lock<std::mutex> guard(connection.lock);
+
+  while (connection.in_flight > 0)
+  {
+    connection.done.wait(guard);
+  }
+
+  return connection.summary;
+}
+
+void Server::answer(Connection& connection, std::string const& request, std::size_t worker)
+{
+  std::string& frame = this->replies[worker];
+  frame.assign(LENGTH_BYTES + RESPONSE_HEADER, '\0');
+
+  if (request.size() < REQUEST_HEADER)
+  {
+    std::uint32_t id = (request.size() >= ID_BYTES) ? get_u32(request.data()) : 0;
+    frame += "the request is too short";
+    respond(connection, id, BAD_REQUEST, frame);
+    return;
+  }
+
+  std::uint32_t id = get_u32(request.data());
+  std::uint8_t command = request[ID_BYTES];
+  std::uint32_t timeout = get_u32(request.data() + ID_BYTES + 1);
+
+  if (command != SOLVE && command != COUNT)
+  {
+    frame += "unknown command " + std::to_string(command);
+    respond(connection, id, BAD_REQUEST, frame);
+    return;
+  }
+
+  Sudoku& sudoku = this->sudokus[worker];
+  PuzzleReader reader(request.data() + REQUEST_HEADER, request.size() - REQUEST_HEADER);
+
+  if (!sudoku.read_puzzle_from_reader(reader))
+  {
+    //either the reader found a problem, or the puzzle is well-formed but contradicts itself
+    frame += reader.failed() ? reader.error_message() : "the known values conflict";
+    respond(connection, id, INVALID, frame);
+    return;
+  }
+
+  //a client that went away does not need its answers any more
+  SolveLimits limits;
+
+  if (timeout > 0)
+  {
+    limits = SolveLimits::within(std::chrono::milliseconds(timeout));
+  }
+
+  limits.cancel = &connection.closed;
+
+  if (command == COUNT)
+  {
+    SolutionCount count = sudoku.count_solutions(2, limits);
+
+    if (count.aborted)
+    {
+      frame += "the count ran out of time";
+      respond(connection, id, ABORTED, frame);
+    }
+    else
+    {
+      frame += std::to_string(count.solutions);
+      respond(connection, id, OK, frame);
+    }
+
+    return;
+  }
+
+  switch (sudoku.solve_bitboard_style(limits))
+  {
+    case SolveResult::SOLVED:
+    {
+      //write the solution straight into the frame
+      std::size_t length = frame.size(), size = sudoku.size(Layout::COMPACT);
+      frame.resize(length + size);
+      sudoku.write(&frame[length], size, Layout::COMPACT);
+      respond(connection, id, OK, frame);
+      break;
+    }
+    case SolveResult::UNSOLVABLE:
+      frame += "the puzzle has no solution";
+      respond(connection, id, UNSOLVABLE, frame);
+      break;
+    case SolveResult::ABORTED:
+      frame += "the solve ran out of time";
+      respond(connection, id, ABORTED, frame);
+      break;
+  }
+}
+
+void Server::respond(Connection& connection, std::uint32_t id, Status status, std::string& frame)
+{
+  put_u32(&frame[0], frame.size() - LENGTH_BYTES);
+  put_u32(&frame[LENGTH_BYTES], id);
+  frame[LENGTH_BYTES + ID_BYTES] = char(status);
+
+  std::lock_guard<std::mutex> guard(connection.lock);
+  Summary& summary = connection.summary;
+
+  summary.total++;
+  summary.ok += (status == OK);
+  summary.unsolvable += (status == UNSOLVABLE);
+  summary.aborted += (status == ABORTED);
+  summary.invalid += (status == INVALID);
+  summary.bad += (status == BAD_REQUEST);
+
+  if (!connection.closed && !write_fully(connection.out, frame.data(), frame.size()))
+  {
+    connection.closed = true;
+  }
+}
+
+bool Server::listen(std::string const& path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    this->message = path + ": the path is too long for a socket";
+    return false;
+  }
+
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  //a socket left behind by an earlier server would keep this one from binding to the path
+  struct stat info;
+
+  if (stat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+  {
+    unlink(path.c_str());
+  }
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+  if (fd == -1 || bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ||
+      ::listen(fd, SOMAXCONN) == -1)
+  {
+    this->message = path + ": " + std::strerror(errno);
+
+    if (fd != -1)
+    {
+      ::close(fd);
+    }
+
+    return false;
+  }
+
+  std::mutex lock;
+  std::condition_variable finished;
+  std::size_t open = 0;
+
+  while (true)
+  {
+    int client = accept(fd, nullptr, nullptr);
+
+    if (client == -1)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+
+      this->message = path + ": " + std::strerror(errno);
+      break;
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      open++;
+    }
+
+    std::thread([this, client, &lock, &finished, &open]()
+    {
+      this->serve(client, client);
+      ::close(client);
+
+      std::lock_guard<std::mutex> guard(lock);
+      open--;
+      finished.notify_all();
+    }).detach();
+  }
+
+  ::close(fd);
+
+  //the connections that are still open use the pool, so they have to finish first
+  std::unique_lock<std::mutex> guard(lock);
+
+  while (open > 0)
+  {
+    finished.wait(guard);
+  }
+
+  return false;
+}
@@ -0,0 +1,199 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "cache.h"
+#include "sudoku.h"
+#include "thread_pool.h"
+
+/**
+ * @brief Solves puzzles for long-running clients, which send them over a pipe or a socket
+ *
+ * The server keeps a pool of threads (see ThreadPool) and one Sudoku instance per thread, so the
+ * solver state of every board size stays warm from one request to the next. A connection is a
+ * stream of requests one way and a stream of responses the other, both made of frames: a 4-byte
+ * length, and then that many bytes. All the integers are unsigned and big-endian.
+ *
+ * A request frame holds a 4-byte request id, a 1-byte command (see Command), a 4-byte timeout in
+ * milliseconds (0 for none), and then the puzzle, in either of the formats read by the Sudoku
+ * class. A response frame holds the id of its request, a 1-byte status (see Status), and then some
+ * text: the solution on one line, the number of solutions, or what was wrong with the request.
+ *
+ * A client may send as many requests as it likes without waiting for the responses. Every request
+ * is a task for the pool, and its response is written as soon as it is ready, so the responses
+ * can come back in any order. Once too many requests of a connection are in flight, the server
+ * stops reading from it until some of them are done. When a response cannot be written, because
+ * the client went away, the solves and counts still in flight for it are cancelled. Writing to a
+ * closed socket or pipe raises SIGPIPE, so a program that serves clients should ignore that signal.
+ **/
+class Server
+{
+public:
+  /**
+   * @brief What a request asks for
+   **/
+  enum Command : std::uint8_t
+  {
+    /**
+     * @brief Solve the puzzle, and return the solution in the format read by
+     *        Sudoku::read_puzzle_from_line().
+     **/
+    SOLVE = 1,
+    /**
+     * @brief Count the solutions of the puzzle up to 2 (see Sudoku::count_solutions()), and return
+     *        the number in decimal. A count that runs out of time is aborted, like a solve.
+     **/
+    COUNT = 2
+  };
+
+  /**
+   * @brief How a request turned out
+   **/
+  enum Status : std::uint8_t
+  {
+    OK = 0,
+    UNSOLVABLE = 1,
+    /**
+     * @brief The solve or count ran out of time.
+     **/
+    ABORTED = 2,
+    /**
+     * @brief The puzzle cannot be read, or its known values conflict.
+     **/
+    INVALID = 3,
+    /**
+     * @brief The frame is too short or too long, or the command is unknown.
+     **/
+    BAD_REQUEST = 4
+  };
+
+  /**
+   * @brief How the requests of a connection turned out
+   **/
+  struct Summary
+  {
+    Summary();
+
+    std::size_t total, ok, unsolvable, aborted, invalid, bad;
+  };
+
+  /**
+   * @brief Start the workers
+   *
+   * @param threads The number of workers, or 0 for one per hardware thread.
+   * @param cache The number of solutions to keep in a cache shared by the workers (see
+   *        SolutionCache), or 0 for no cache.
+   **/
+  explicit Server(std::size_t threads = 0, std::size_t cache = 0);
+
+  Server(Server const&) = delete;
+  Server& operator =(Server const&) = delete;
+
+  /**
+   * @brief The number of workers
+   **/
+  std::size_t threads() const;
+  /**
+   * @brief How well the cache is doing, if there is one
+   **/
+  SolutionCache::Metrics cache_metrics() const;
+
+  /**
+   * @brief Serve one connection until the client stops sending requests, and every response has
+   *        been written. Several connections can be served at once, from different threads.
+   *
+   * @param in The file descriptor requests are read from, such as standard input or a socket.
+   * @param out The file descriptor responses are written to, which can be the same one.
+   * @return Server::Summary The number of requests of each kind.
+   **/
+  Summary serve(int in, int out);
+  /**
+   * @brief Listen on a Unix domain socket, and serve every client that connects on a thread of its
+   *        own. A socket left over at the same path is replaced.
+   *
+   * @param path The path of the socket.
+   * @return bool False if the socket cannot be opened, or stops taking connections. If so, error()
+   *         tells why. Otherwise, this never returns.
+   **/
+  bool listen(std::string const& path);
+  /**
+   * @brief Why listen() returned
+   **/
+  std::string const& error() const;
+
+  /**
+   * @brief The largest request frame, which is plenty for a 144*144 puzzle in any format.
+   **/
+  static std::uint32_t const MAX_FRAME = 1 << 20;
+
+private:
+  /**
+   * @brief The state shared by the reader of a connection and the tasks answering its requests
+   **/
+  struct Connection
+  {
+    explicit Connection(int out);
+
+    int out;
+    /**
+     * @brief Guards the writes and everything below, and is signaled whenever a request is done.
+     **/
+    std::mutex lock;
+    std::condition_variable done;
+    std::size_t in_flight;
+    Summary summary;
+    /**
+     * @brief Raised once a response cannot be written, which also cancels the solves in flight.
+     **/
+    std::atomic<bool> closed;
+  };
+
+  /**
+   * @brief Answer one request on a worker, and write the response
+   **/
+  void answer(Connection& connection, std::string const& request, std::size_t worker);
+  /**
+   * @brief Write a response, and count it
+   **/
+  static void respond(Connection& connection, std::uint32_t id, Status status,
+                      std::string& frame);
+
+  SolutionCache solutions;
+  ThreadPool pool;
+  /**
+   * @brief The puzzle state of every worker.
+   **/
+  std::vector<Sudoku> sudokus;
+  /**
+   * @brief The response being built by every worker, which keeps its capacity between requests.
+   **/
+  std::vector<std::string> replies;
+  std::string message;
+};
+
+#endif // SERVER_H
@@ -0,0 +1,562 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "bits.h"
+#include "board.h"
+#include "grid.h"
+#include "stats.h"
+#include "validator.h"
+#include "watchdog.h"
+
+/**
+ * @brief The hooks through which several solvers share the search of one tree
+ *
+ * A search that is given a splitter checks with it before every node: it stops as soon as the
+ * splitter says so, and while the splitter is hungry (i.e., some worker has nothing to do), it
+ * gives away the untried colors of its shallowest node, each as a subtree of its own. Solutions
+ * are reported to the splitter, which decides whether the search goes on. See ParallelSearch.
+ *
+ * @tparam Geometry The shape of the boards being searched.
+ **/
+template <class Geometry>
+class SearchSplitter
+{
+public:
+  virtual ~SearchSplitter()
+  {
+  }
+
+  /**
+   * @brief Whether the search should give up
+   **/
+  virtual bool stopped() const = 0;
+  /**
+   * @brief Whether some worker would take a subtree off the search's hands
+   **/
+  virtual bool hungry() const = 0;
+  /**
+   * @brief Hand a subtree over to another worker
+   *
+   * @param board The board at the root of the subtree, which the splitter may copy but not keep.
+   **/
+  virtual void donate(BasicBoard<Geometry> const& board) = 0;
+  /**
+   * @brief Report a solution
+   *
+   * @param board The solved board.
+   * @return bool Whether the search should go on.
+   **/
+  virtual bool solution(BasicBoard<Geometry> const& board) = 0;
+};
+
+/**
+ * @brief A splitter that never splits, and only watches over a count: it copies the first few
+ *        solutions out of the search, and stops the search once it has visited a number of nodes
+ *
+ * @tparam Geometry The shape of the boards being searched.
+ **/
+template <class Geometry>
+class CountHooks : public SearchSplitter<Geometry>
+{
+public:
+  /**
+   * @brief Construct the hooks
+   *
+   * @param witnesses Where to copy the solutions. The grids must have the right size.
+   * @param room The number of grids in witnesses.
+   * @param budget The number of nodes after which the search is stopped.
+   **/
+  CountHooks(Grid* witnesses, std::size_t room, std::size_t budget)
+    : witnesses(witnesses), room(room), budget(budget), found(0), nodes(0)
+  {
+  }
+
+  /**
+   * @brief Whether the search ran out of nodes
+   **/
+  bool exhausted() const
+  {
+    return this->nodes > this->budget;
+  }
+
+  bool stopped() const
+  {
+    return ++this->nodes > this->budget;
+  }
+
+  bool hungry() const
+  {
+    return false;
+  }
+
+  void donate(BasicBoard<Geometry> const&)
+  {
+  }
+
+  bool solution(BasicBoard<Geometry> const& board)
+  {
+    if (this->found < this->room)
+    {
+      board.store(this->witnesses[this->found]);
+    }
+
+    this->found++;
+    return true;
+  }
+
+private:
+  Grid* witnesses;
+  std::size_t room, budget, found;
+  mutable std::size_t nodes;
+};
+
+/**
+ * @brief The backtracking searches behind the Sudoku solver methods
+ *
+ * The searches are written as loops over an explicit stack of decisions rather than as recursive
+ * functions. A search never makes more decisions than there are cells on the board, so the stack
+ * is allocated once, in the constructor, with room for one decision per cell. That puts a fixed,
+ * known bound on the memory a search uses (a few dozen bytes per cell, even for a 144*144 board)
+ * and keeps deep searches from overflowing the call stack.
+ *
+ * @tparam Geometry The shape of the boards being searched (FixedGeometry or DynamicGeometry).
+ **/
+template <class Geometry>
+class BasicSolver
+{
+public:
+  typedef typename Geometry::mask_type mask_type;
+
+  /**
+   * @brief Construct a solver for boards of a given shape
+   *
+   * @param geometry The shape of the boards that will be searched.
+   **/
+  BasicSolver(Geometry const& geometry);
+
+  /**
+   * @brief Fill in some statistics during every search from now on (see SolveStats)
+   *
+   * @param stats Where to add the counts, or nullptr to stop counting.
+   **/
+  void watch(SolveStats* stats);
+  /**
+   * @brief Keep every search from now on within some limits (see Watchdog). A search that runs
+   *        out of them stops where it is, as if it had explored the whole tree.
+   *
+   * @param watchdog The limits, or nullptr for none.
+   **/
+  void guard(Watchdog* watchdog);
+  /**
+   * @brief Whether the last search stopped because it ran out of its limits
+   **/
+  bool expired() const;
+
+  /**
+   * @brief Color a board using the graph n-colorability method, with constraint propagation. If
+   *        a coloring is found, it is left on the board; otherwise the board is left unchanged.
+   *
+   * @param board The Sudoku game board.
+   * @param policy The order in which the nodes are colored.
+   * @return bool Whether we were able to find a coloring for the Sudoku board.
+   **/
+  bool solve(BasicBoard<Geometry>& board, Branching policy);
+  /**
+   * @brief Count the colorings of a board, stopping early once a limit is reached. The board is
+   *        always left unchanged.
+   *
+   * @param board The Sudoku game board.
+   * @param limit The number of solutions after which the search gives up.
+   * @param witnesses Where to copy the first solutions found, if anywhere.
+   * @param room The number of grids in witnesses.
+   * @param budget The number of nodes after which the search gives up, as if it had reached the
+   *               limit.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  std::size_t count(BasicBoard<Geometry>& board, std::size_t limit, Grid* witnesses = nullptr,
+                    std::size_t room = 0, std::size_t budget = std::size_t(-1));
+  /**
+   * @brief Search a board, or a subtree of it, together with other solvers (see SearchSplitter).
+   *        The solutions are only reported to the splitter, and the board is left in whatever
+   *        state the search stopped in.
+   *
+   * @param board The Sudoku game board.
+   * @param policy The order in which the nodes are colored.
+   * @param splitter The hooks shared by all the solvers.
+   * @return std::size_t The number of solutions this solver found.
+   **/
+  std::size_t share(BasicBoard<Geometry>& board, Branching policy,
+                    SearchSplitter<Geometry>& splitter);
+
+  /**
+   * @brief Fill in a grid by trying every value in every unknown cell, and only checking the board
+   *        once it is full. If a solution is found, it is left in the grid; otherwise the grid is
+   *        left unchanged.
+   *
+   * @param grid The Sudoku game board.
+   * @return bool Whether we were able to find a solution for the Sudoku board.
+   **/
+  bool bruteforce(Grid& grid);
+
+private:
+  /**
+   * @brief A node of the search tree that is still being explored
+   **/
+  struct Frame
+  {
+    /**
+     * @brief The length of the undo trail before and after propagating the node.
+     **/
+    std::size_t entry, mark;
+    /**
+     * @brief The cell being colored.
+     **/
+    std::size_t cell;
+    /**
+     * @brief The colors that have not been tried in the cell yet.
+     **/
+    mask_type colors;
+  };
+
+  /**
+   * @brief The depth-first search shared by solve(), count() and share()
+   *
+   * @param board The Sudoku game board.
+   * @param policy The order in which the nodes are colored.
+   * @param limit The number of solutions after which the search gives up.
+   * @param keep Whether to leave the last solution found on the board when the limit is reached.
+   * @param splitter The hooks for sharing the search with other solvers, if any.
+   * @return std::size_t The number of solutions found, which is at most the limit.
+   **/
+  std::size_t search(BasicBoard<Geometry>& board, Branching policy, std::size_t limit, bool keep,
+                     SearchSplitter<Geometry>* splitter);
+  /**
+   * @brief Give the untried colors of the shallowest node that has any away to the splitter
+   *
+   * @param board The Sudoku game board, which is left as it was.
+   * @param splitter The hooks for sharing the search with other solvers.
+   **/
+  void split(BasicBoard<Geometry> const& board, SearchSplitter<Geometry>& splitter);
+
+  /**
+   * @brief The decisions made on the way down the search tree.
+   **/
+  std::vector<Frame> stack;
+  /**
+   * @brief Where to count what the searches go through, if anywhere.
+   **/
+  SolveStats* stats;
+  /**
+   * @brief The limits of the searches, if any.
+   **/
+  Watchdog* watchdog;
+};
+
+template <class Geometry>
+BasicSolver<Geometry>::BasicSolver(Geometry const& geometry) : stats(nullptr), watchdog(nullptr)
+{
+  //every decision colors at least one cell, so there can never be more decisions than cells
+  this->stack.reserve(geometry.cells() + 1);
+}
+
+template <class Geometry>
+void BasicSolver<Geometry>::watch(SolveStats* stats)
+{
+  this->stats = stats;
+}
+
+template <class Geometry>
+void BasicSolver<Geometry>::guard(Watchdog* watchdog)
+{
+  this->watchdog = watchdog;
+}
+
+template <class Geometry>
+bool BasicSolver<Geometry>::expired() const
+{
+  return this->watchdog != nullptr && this->watchdog->tripped();
+}
+
+template <class Geometry>
+bool BasicSolver<Geometry>::solve(BasicBoard<Geometry>& board, Branching policy)
+{
+  return this->search(board, policy, 1, true, nullptr) == 1;
+}
+
+template <class Geometry>
+std::size_t BasicSolver<Geometry>::count(BasicBoard<Geometry>& board, std::size_t limit,
+                                         Grid* witnesses, std::size_t room,
+                                         std::size_t budget)
+{
+  if (room == 0 && budget == std::size_t(-1))
+  {
+    return this->search(board, Branching::MOST_CONSTRAINED, limit, false, nullptr);
+  }
+
+  CountHooks<Geometry> hooks(witnesses, room, budget);
+  std::size_t entry = board.mark();
+  std::size_t found = this->search(board, Branching::MOST_CONSTRAINED, limit, false, &hooks);
+
+  //a search that ran out of nodes stops in the middle of the tree, so back out of it by hand
+  board.undo(entry);
+  return hooks.exhausted() ? limit : found;
+}
+
+template <class Geometry>
+std::size_t BasicSolver<Geometry>::share(BasicBoard<Geometry>& board, Branching policy,
+                                         SearchSplitter<Geometry>& splitter)
+{
+  return this->search(board, policy, std::size_t(-1), false, &splitter);
+}
+
+template <class Geometry>
+std::size_t BasicSolver<Geometry>::search(BasicBoard<Geometry>& board, Branching policy,
+                                          std::size_t limit, bool keep,
+                                          SearchSplitter<Geometry>* splitter)
+{
+  std::size_t found = 0;
+  bool descend = true;
+
+  this->stack.clear();
+
+  while (true)
+  {
+    if (this->watchdog != nullptr && this->watchdog->expired())
+    {
+      return found;
+    }
+
+    if (splitter != nullptr)
+    {
+      if (splitter->stopped())
+      {
+        return found;
+      }
+
+      if (splitter->hungry())
+      {
+        this->split(board, *splitter);
+      }
+    }
+
+    if (descend)
+    {
+      std::size_t entry = board.mark(), unknown;
+
+      //the row-major order picks up from the cell colored by the parent node
+      std::size_t from = this->stack.empty() ? 0 : this->stack.back().cell;
+
+      //color every forced node first, and give up on this branch if it turns out to be a dead end
+      bool alive = board.propagate();
+
+      if (this->stats != nullptr)
+      {
+        this->stats->nodes++;
+        this->stats->backtracks += !alive;
+        this->stats->propagations += board.mark() - entry;
+      }
+
+      if (!alive)
+      {
+        board.undo(entry);
+      }
+      //check if we can keep coloring nodes, or if we need to stop and assess the generated board
+      else if (board.next_unknown(policy, from, unknown))
+      {
+        Frame frame;
+        frame.entry = entry;
+        frame.mark = board.mark();
+        frame.cell = unknown;
+        frame.colors = board.candidates(unknown);
+        this->stack.push_back(frame);
+
+        if (this->stats != nullptr)
+        {
+          this->stats->max_depth = std::max<std::uint64_t>(this->stats->max_depth,
+                                                           this->stack.size());
+        }
+      }
+      //the board is completely colored from the candidate masks, so it is a valid coloring
+      else if (++found == limit && keep)
+      {
+        return found;
+      }
+      else if (splitter != nullptr && !splitter->solution(board))
+      {
+        return found;
+      }
+      else
+      {
+        board.undo(entry);
+      }
+    }
+
+    //move on to the next color of the deepest node that has any left, backing out of the others
+    descend = false;
+
+    while (!this->stack.empty() && !descend)
+    {
+      Frame& frame = this->stack.back();
+      board.undo(frame.mark);
+
+      if (frame.colors != 0 && found < limit)
+      {
+        board.place(frame.cell, Bits::lowest_color(frame.colors));
+        frame.colors = Bits::drop_lowest(frame.colors);
+        descend = true;
+      }
+      else
+      {
+        board.undo(frame.entry);
+        this->stack.pop_back();
+      }
+    }
+
+    if (!descend)
+    {
+      //the whole tree has been explored
+      return found;
+    }
+  }
+}
+
+template <class Geometry>
+void BasicSolver<Geometry>::split(BasicBoard<Geometry> const& board,
+                                  SearchSplitter<Geometry>& splitter)
+{
+  for (Frame& frame : this->stack)
+  {
+    if (frame.colors != 0)
+    {
+      //rewind a copy of the board to the node, and hand over one subtree per untried color
+      BasicBoard<Geometry> subtree(board);
+      subtree.undo(frame.mark);
+
+      for (; frame.colors != 0; frame.colors = Bits::drop_lowest(frame.colors))
+      {
+        subtree.place(frame.cell, Bits::lowest_color(frame.colors));
+        splitter.donate(subtree);
+        subtree.undo(frame.mark);
+      }
+
+      return;
+    }
+  }
+}
+
+template <class Geometry>
+bool BasicSolver<Geometry>::bruteforce(Grid& grid)
+{
+  const std::size_t n = grid.n();
+  std::size_t cell = 0;
+
+  this->stack.clear();
+
+  while (true)
+  {
+    if (this->watchdog != nullptr && this->watchdog->expired())
+    {
+      //leave the grid as it was
+      for (Frame const& frame : this->stack)
+      {
+        grid.set(frame.cell % n, frame.cell / n, -1);
+      }
+
+      return false;
+    }
+
+    //find the next unknown cell from where we left off
+    while (cell < n * n && grid.get(cell % n, cell / n) != -1)
+    {
+      cell++;
+    }
+
+    if (cell == n * n)
+    {
+      if (this->stats != nullptr)
+      {
+        this->stats->validator_calls++;
+      }
+
+      //the board is completely filled in, but is it a valid solution?
+      if (Validator::is_good_board(grid))
+      {
+        return true;
+      }
+      else if (this->stats != nullptr)
+      {
+        this->stats->backtracks++;
+      }
+    }
+    else
+    {
+      Frame frame;
+      frame.cell = cell;
+      frame.colors = Bits::all_colors<mask_type>(n);
+      this->stack.push_back(frame);
+
+      if (this->stats != nullptr)
+      {
+        this->stats->max_depth = std::max<std::uint64_t>(this->stats->max_depth,
+                                                         this->stack.size());
+      }
+    }
+
+    //move on to the next value of the deepest cell that has any left, clearing the others
+    bool advanced = false;
+
+    while (!this->stack.empty() && !advanced)
+    {
+      Frame& frame = this->stack.back();
+
+      if (frame.colors != 0)
+      {
+        if (this->stats != nullptr)
+        {
+          this->stats->nodes++;
+        }
+
+        grid.set(frame.cell % n, frame.cell / n, Bits::lowest_color(frame.colors));
+        frame.colors = Bits::drop_lowest(frame.colors);
+        cell = frame.cell;
+        advanced = true;
+      }
+      else
+      {
+        grid.set(frame.cell % n, frame.cell / n, -1);
+        this->stack.pop_back();
+      }
+    }
+
+    if (!advanced)
+    {
+      //every combination has been tried
+      return false;
+    }
+  }
+}
+
+#endif // SOLVER_H
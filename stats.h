@@ -0,0 +1,67 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <algorithm>
+#include <cstdint>
+
+/**
+ * @brief What a solver went through to solve (or count the solutions of) one puzzle
+ *
+ * A solver only fills in the statistics when it is given somewhere to put them, and otherwise
+ * keeps no counters at all, so leaving them off costs one well-predicted branch per node. The
+ * exact meaning of a node depends on the solver, but the counts can be compared between puzzles
+ * solved with the same strategy:
+ *  - nodes: the search positions visited; for the backtracking solvers, every time a cell is
+ *    colored by a decision (or, for brute force, a value is tried).
+ *  - backtracks: the positions that turned out to be dead ends.
+ *  - max_depth: the most decisions that were stacked up at once.
+ *  - validator_calls: the calls into Validator.
+ *  - propagations: the cells that propagation filled in without a decision.
+ *  - seconds: the wall time of the whole call, including the setup.
+ *
+ * When a search is split between several threads, the counts are the sums over all of them, and
+ * max_depth is the deepest any of them went.
+ **/
+struct SolveStats
+{
+  SolveStats() : nodes(0), backtracks(0), max_depth(0), validator_calls(0), propagations(0),
+                 seconds(0)
+  {
+  }
+
+  /**
+   * @brief Add in the statistics of another part of the same search
+   **/
+  SolveStats& operator +=(SolveStats const& other)
+  {
+    this->nodes += other.nodes;
+    this->backtracks += other.backtracks;
+    this->max_depth = std::max(this->max_depth, other.max_depth);
+    this->validator_calls += other.validator_calls;
+    this->propagations += other.propagations;
+    return *this;
+  }
+
+  std::uint64_t nodes, backtracks, max_depth, validator_calls, propagations;
+  double seconds;
+};
+
+#endif // STATS_H
@@ -18,144 +18,218 @@
 
 #include "sudoku.h"
 #include "validator.h"
+#include "dlx.h"
+#include "kernel.h"
+#include "serializer.h"
 
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
-#include <boost/algorithm/string.hpp>
+#include <chrono>
 
-Sudoku::Sudoku() : grid(0), status_ok(false)
+namespace
 {
-}
-
-bool Sudoku::insert_row(std::vector<std::string>& tokens, std::size_t y)
-{
-  for (std::size_t x = 0; x < this->grid.n(); x++)
+  /**
+   * @brief Points a solver core at the statistics and the watchdog of one solve, times the solve
+   *        into the statistics, and unhooks both from the core once the solve is over
+   **/
+  class SolveScope
   {
-    std::string const& token = tokens[x];
-
-    try
+  public:
+    SolveScope(Kernel& kernel, SolveStats* stats, Watchdog* watchdog = nullptr)
+      : core(kernel), watched(stats), guarded(watchdog)
     {
-      int value = std::stoi(token);
+      this->core.watch(this->watched);
+      this->core.guard(this->guarded);
 
-      //integer tokens must be between 1 and n, and unknowns should be question marks
-      if (value < 1 || value > (int)this->grid.n())
-      {
-        //invalid value in board
-        return false;
-      }
-      else
+      if (this->watched != nullptr)
       {
-        this->grid.set(x, y, value);
+        this->start = std::chrono::steady_clock::now();
       }
     }
-    catch (std::invalid_argument &)
+
+    ~SolveScope()
     {
-      if (token == "?")
-      {
-        this->grid.set(x, y, -1);
-      }
-      else
+      if (this->watched != nullptr)
       {
-        //invalid character in board
-        return false;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - this->start;
+        this->watched->seconds = elapsed.count();
       }
+
+      this->core.watch(nullptr);
+      this->core.guard(nullptr);
+    }
+
+    SolveStats* stats() const
+    {
+      return this->watched;
+    }
+
+    Watchdog* watchdog() const
+    {
+      return this->guarded;
     }
+
+  private:
+    Kernel& core;
+    SolveStats* watched;
+    Watchdog* guarded;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /**
+   * @brief Only hand out a watchdog when there is something to watch for, so that unbounded
+   *        solves do not pay for the checks
+   **/
+  Watchdog* guard_for(Watchdog& watchdog)
+  {
+    return watchdog.limits().bounded() ? &watchdog : nullptr;
   }
 
-  return true;
+  SolveResult outcome(bool solved, Watchdog const& watchdog)
+  {
+    if (solved)
+    {
+      return SolveResult::SOLVED;
+    }
+
+    return watchdog.tripped() ? SolveResult::ABORTED : SolveResult::UNSOLVABLE;
+  }
 }
 
-bool Sudoku::parse_puzzle(std::istream& f)
+Sudoku::Sudoku() : grid(0), status_ok(false), collecting(false), solutions(nullptr)
 {
-  std::string line;
-  std::vector<std::string> tokens;
-
-  //read the first line, to figure out n
-  std::getline(f, line);
-  boost::split(tokens, line, boost::is_any_of(" "));
-  std::size_t n = tokens.size();
+}
 
-  if (n == 0 || line.empty())
+Sudoku::Sudoku(Sudoku const& sudoku)
+  : grid(sudoku.grid), status_ok(sudoku.status_ok), statistics(sudoku.statistics),
+    collecting(sudoku.collecting), solutions(sudoku.solutions)
+{
+  if (sudoku.kernel)
   {
-    //empty puzzle
-    return false;
+    this->kernel = Kernel::create(sudoku.kernel->n());
   }
+}
 
-  //make sure n is a perfect square
-  std::size_t n_sq = std::size_t(sqrt(n));
+Sudoku& Sudoku::operator=(Sudoku const& sudoku)
+{
+  this->grid = sudoku.grid;
+  this->status_ok = sudoku.status_ok;
+  this->statistics = sudoku.statistics;
+  this->collecting = sudoku.collecting;
+  this->solutions = sudoku.solutions;
 
-  if (n_sq * n_sq != n && (n_sq + 1) * (n_sq + 1) != n)
+  if (sudoku.kernel && (!this->kernel || this->kernel->n() != sudoku.kernel->n()))
   {
-    //n is not a perfect square
-    return false;
+    this->kernel = Kernel::create(sudoku.kernel->n());
   }
 
-  //make sure n is not too big
+  return *this;
+}
 
-  if (n > 64)
+bool Sudoku::parse_puzzle(PuzzleReader& reader)
+{
+  //the reader sizes the grid to fit the puzzle
+  if (!reader.next(this->grid))
   {
-    //the board cannot be solved with this program
     return false;
   }
 
-  //create the n*n grid
-  this->grid.reset(n);
+  this->fit_kernel();
+  return true;
+}
 
-  //put in the first row
-  if (!this->insert_row(tokens, 0))
+void Sudoku::fit_kernel()
+{
+  if (!this->kernel || this->kernel->n() != this->grid.n())
   {
-    return false;
+    this->kernel = Kernel::create(this->grid.n());
   }
+}
 
-  //read n-1 lines
-  for (std::size_t y = 1; y < n; y++)
+bool Sudoku::validate()
+{
+  if (this->collecting)
   {
-    std::getline(f, line);
-    boost::split(tokens, line, boost::is_any_of(" "));
+    this->statistics.validator_calls++;
+  }
 
-    //each line must have n tokens
-    if (tokens.size() != n)
-    {
-      //invalid board
-      return false;
-    }
+  //whether this board is solvable
+  return Validator::is_good_partial_board(this->grid);
+}
 
-    //insert that row
-    if (!this->insert_row(tokens, y))
-    {
-      return false;
-    }
+SolveStats* Sudoku::begin_solve()
+{
+  if (!this->status_ok)
+  {
+    throw std::logic_error("Puzzle has not been initialized");
   }
 
-  return true;
+  this->statistics = SolveStats();
+  return this->collecting ? &this->statistics : nullptr;
 }
 
-bool Sudoku::validate() const
+void Sudoku::collect_stats(bool enabled)
 {
-  //whether this board is solvable
-  return Validator::is_good_partial_board(this->grid);
+  this->collecting = enabled;
+  this->statistics = SolveStats();
+}
+
+SolveStats const& Sudoku::stats() const
+{
+  return this->statistics;
+}
+
+void Sudoku::use_cache(SolutionCache* cache)
+{
+  this->solutions = cache;
+}
+
+bool Sudoku::recall(SolveResult& result)
+{
+  return this->solutions != nullptr && this->solutions->lookup(this->grid, this->form, result);
+}
+
+SolveResult Sudoku::remember(SolveResult result)
+{
+  if (this->solutions != nullptr)
+  {
+    this->solutions->store(this->form, this->grid, result);
+  }
+
+  return result;
 }
 
 bool Sudoku::read_puzzle_from_file(std::istream& f)
 {
-  if (this->parse_puzzle(f))
+  std::string text;
+
+  //only take the lines of one puzzle out of the stream
+  if (!PuzzleReader::read(f, text))
   {
-    if (this->validate())
-    {
-      this->status_ok = true;
-      return true;
-    }
+    this->status_ok = false;
+    return false;
   }
 
-  return false;
+  return this->read_puzzle_from_string(text);
 }
 
 bool Sudoku::read_puzzle_from_string(std::string const& s)
 {
-  std::stringstream iss(s);
+  PuzzleReader reader(s.data(), s.size());
+  return this->read_puzzle_from_reader(reader);
+}
+
+bool Sudoku::read_puzzle_from_line(std::string const& line)
+{
+  return this->read_puzzle_from_string(line);
+}
+
+bool Sudoku::read_puzzle_from_reader(PuzzleReader& reader)
+{
+  this->status_ok = false;
 
-  if (this->parse_puzzle(iss))
+  if (this->parse_puzzle(reader))
   {
     if (this->validate())
     {
@@ -167,6 +241,16 @@ bool Sudoku::read_puzzle_from_string(std::string const& s)
   return false;
 }
 
+bool Sudoku::read_puzzle_from_grid(Grid const& grid)
+{
+  this->status_ok = false;
+  this->grid = grid;
+  this->fit_kernel();
+
+  this->status_ok = this->validate();
+  return this->status_ok;
+}
+
 void Sudoku::print(std::ostream& out) const
 {
   if (!this->status_ok)
@@ -174,200 +258,250 @@ void Sudoku::print(std::ostream& out) const
     throw std::logic_error("Puzzle has not been initialized");
   }
 
-  out << this->to_s() << std::endl;
+  Serializer::write(this->grid, Layout::SPACED, out);
+  out << '\n';
 }
 
 std::string Sudoku::to_s() const
 {
-  std::string str = this->grid.to_s();
-  boost::replace_all(str, "-1", "?");
+  std::string str(Serializer::size(this->grid, Layout::SPACED), '\0');
+  Serializer::write(this->grid, Layout::SPACED, &str[0], str.size());
   return str;
 }
 
-bool Sudoku::find_unknown(Grid& cur_grid, std::size_t cur_x, std::size_t cur_y,
-  std::size_t& x_out, std::size_t& y_out)
+void Sudoku::print_line(std::ostream& out) const
 {
-  //find the next unknown node from where we left off, so we don't need to re-examine any elements
-  for (std::size_t y = cur_y; y < cur_grid.n(); y++, cur_x = 0)
+  if (!this->status_ok)
   {
-    for (std::size_t x = cur_x; x < cur_grid.n(); x++)
-    {
-      if (cur_grid.get(x, y) == -1)
-      {
-        x_out = x;
-        y_out = y;
-        return true;
-      }
-    }
+    throw std::logic_error("Puzzle has not been initialized");
   }
 
-  return false;
+  Serializer::write(this->grid, Layout::COMPACT, out);
+  out << '\n';
 }
 
-bool Sudoku::color_node(Grid& cur_grid, std::size_t cur_x, std::size_t cur_y)
+std::size_t Sudoku::write(char* buffer, std::size_t capacity, Layout layout) const
 {
-  std::size_t unknown_x, unknown_y;
-
-  //check if we can keep coloring nodes, or if we need to stop and assess the generated board
-  if (find_unknown(cur_grid, cur_x, cur_y, unknown_x, unknown_y))
+  if (!this->status_ok)
   {
-    std::uint_fast64_t colors = Validator::good_colors(cur_grid, unknown_x, unknown_y);
+    throw std::logic_error("Puzzle has not been initialized");
+  }
 
-    //clone the existing game board
-    Grid new_grid(cur_grid);
+  return Serializer::write(this->grid, layout, buffer, capacity);
+}
 
-    for (int i = 1; i <= (int)cur_grid.n(); i++)
-    {
-      //can we use this color here?
-      if ((colors & (1 << (i - 1))) != 0)
-      {
-        //color the node
-        new_grid.set(unknown_x, unknown_y, i);
-
-        //if the coloring was successful, then return the colored graph indicate success
-        if (color_node(new_grid, unknown_x, unknown_y))
-        {
-          cur_grid = new_grid;
-          return true;
-        }
-      }
-    }
+std::size_t Sudoku::size(Layout layout) const
+{
+  return Serializer::size(this->grid, layout);
+}
 
-    //we couldn't find a coloring :(
-    return false;
+std::size_t Sudoku::n() const
+{
+  return this->status_ok ? this->grid.n() : 0;
+}
+
+bool Sudoku::solved() const
+{
+  if (!this->status_ok)
+  {
+    throw std::logic_error("Puzzle has not been initialized");
   }
-  else
+
+  return Validator::is_good_board(this->grid);
+}
+
+SolveResult Sudoku::solve_colorability_style(SolveLimits const& limits)
+{
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
+
+  if (this->recall(result))
   {
-    //the board is completely colored, so we can't color any more nodes, but is it a valid coloring?
-    return Validator::is_good_board(cur_grid);
+    return result;
   }
+
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  bool solved = this->kernel->solve(this->grid, Branching::ROW_MAJOR);
+  return this->remember(outcome(solved, watchdog));
 }
 
-void Sudoku::solve_colorability_style()
+SolveResult Sudoku::solve_dsatur_style(SolveLimits const& limits)
 {
-  if (!this->status_ok)
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
+
+  if (this->recall(result))
   {
-    throw std::logic_error("Puzzle has not been initialized");
+    return result;
   }
 
-  color_node(this->grid);
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  bool solved = this->kernel->solve(this->grid, Branching::MOST_CONSTRAINED);
+  return this->remember(outcome(solved, watchdog));
 }
 
-bool Sudoku::bruteforce_node(Grid& cur_grid, std::size_t cur_x, std::size_t cur_y)
+SolveResult Sudoku::solve_bruteforce_style(SolveLimits const& limits)
 {
-  std::size_t unknown_x, unknown_y;
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
 
-  //check if we can keep coloring nodes, or if we need to stop and assess the generated board
-  if (find_unknown(cur_grid, cur_x, cur_y, unknown_x, unknown_y))
+  if (this->recall(result))
   {
-    //clone the existing game board
-    Grid new_grid(cur_grid);
+    return result;
+  }
 
-    for (int i = 1; i <= (int)cur_grid.n(); i++)
-    {
-      //color the cell value
-      new_grid.set(unknown_x, unknown_y, i);
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  bool solved = this->kernel->bruteforce(this->grid);
+  return this->remember(outcome(solved, watchdog));
+}
 
-      //if the coloring was successful, then return the colored graph indicate success
-      if (bruteforce_node(new_grid, unknown_x, unknown_y))
-      {
-        cur_grid = new_grid;
-        return true;
-      }
-    }
+SolveResult Sudoku::solve_dlx(SolveLimits const& limits)
+{
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
 
-    //we couldn't find a solution :(
-    return false;
+  if (this->recall(result))
+  {
+    return result;
   }
-  else
+
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  DancingLinks dlx(this->grid, scope.stats(), scope.watchdog());
+
+  bool solved = dlx.solve();
+
+  if (solved)
   {
-    //the board is completely colored, so we can't color any more nodes, but is it a valid coloring?
-    return Validator::is_good_board(cur_grid);
+    dlx.store(this->grid);
   }
+
+  return this->remember(outcome(solved, watchdog));
 }
 
-void Sudoku::solve_bruteforce_style()
+SolveResult Sudoku::solve_bitboard_style(SolveLimits const& limits)
 {
-  if (!this->status_ok)
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
+
+  if (this->recall(result))
   {
-    throw std::logic_error("Puzzle has not been initialized");
+    return result;
   }
 
-  bruteforce_node(this->grid);
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  bool solved = this->kernel->solve_bitboard(this->grid);
+  return this->remember(outcome(solved, watchdog));
 }
 
-int Sudoku::singular_decider(Grid& cur_grid, bool found_one, std::size_t cur_x, std::size_t cur_y)
+SolveResult Sudoku::solve_parallel_style(std::size_t threads, SolveLimits const& limits)
 {
-  std::size_t unknown_x, unknown_y;
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveResult result;
 
-  //check if we can keep coloring nodes, or if we need to stop and assess the generated board
-  if (find_unknown(cur_grid, cur_x, cur_y, unknown_x, unknown_y))
+  if (this->recall(result))
   {
-    std::uint_fast64_t colors = Validator::good_colors(cur_grid, unknown_x, unknown_y);
+    return result;
+  }
 
-    //clone the existing game board
-    Grid new_grid(cur_grid);
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  ThreadPool pool(threads);
+  bool solved = this->kernel->solve_parallel(this->grid, Branching::MOST_CONSTRAINED, pool);
+  return this->remember(outcome(solved, watchdog));
+}
 
-    for (int i = 1; i <= (int)cur_grid.n(); i++)
-    {
-      //can we use this color here?
-      if ((colors & (1 << (i - 1))) != 0)
-      {
-        //color the node
-        new_grid.set(unknown_x, unknown_y, i);
-
-        //if the coloring was successful, then return the colored graph indicate success
-        switch (singular_decider(new_grid, found_one, unknown_x, unknown_y))
-        {
-          case 0: { break; } //that branch did not yield a solution, so keep going
-          case 1: { found_one = true; break; } //found one solution, so keep going
-          case 2: { return 2; } //confirmed multiple solutions, so stop
-        }
-      }
-    }
+std::size_t Sudoku::count_solutions(std::size_t limit, std::vector<Grid>* witnesses)
+{
+  return this->count_solutions(limit, SolveLimits(), witnesses).solutions;
+}
+
+SolutionCount Sudoku::count_solutions(std::size_t limit, SolveLimits const& limits,
+                                      std::vector<Grid>* witnesses)
+{
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  SolutionCount count;
+
+  if (witnesses != nullptr)
+  {
+    witnesses->clear();
+  }
+
+  if (limit == 0 || !this->validate())
+  {
+    return count;
+  }
 
-    //we're done with this branch
-    return found_one ? 1 : 0;
+  if (witnesses == nullptr)
+  {
+    count.solutions = this->kernel->count(this->grid, limit, nullptr, 0, std::size_t(-1));
   }
   else
   {
-    //the board is completely colored, so we can't color any more nodes, but is it a valid coloring?
-    if (Validator::is_good_board(cur_grid))
-    {
-      if (found_one)
-      {
-        //oh no, we've got multiple solutions!
-        return 2;
-      }
-      else
-      {
-        //this is just the first solution
-        return 1;
-      }
-    }
-    else
-    {
-      //this branch did not yield a solution
-      return 0;
-    }
+    witnesses->assign(2, Grid(this->grid.n()));
+    count.solutions = this->kernel->count(this->grid, limit, witnesses->data(), 2,
+                                          std::size_t(-1));
+    witnesses->resize(std::min<std::size_t>(count.solutions, 2), this->grid);
   }
+
+  //a count that reached its limit is done, even if the watchdog went off right after
+  count.aborted = watchdog.tripped() && count.solutions < limit;
+  return count;
 }
 
-bool Sudoku::singular()
+bool Sudoku::pencil_marks(Grid& marks)
 {
-  if (!this->status_ok)
+  SolveStats* stats = this->begin_solve();
+  SolveScope scope(*this->kernel, stats);
+
+  if (!this->validate())
   {
-    throw std::logic_error("Puzzle has not been initialized");
+    return false;
   }
 
-  if (this->validate())
+  Grid board(this->grid);
+  board.enable_candidates();
+
+  if (!this->kernel->propagate(board))
   {
-    return (singular_decider(this->grid) == 1);
+    return false;
   }
-  else
+
+  marks = board;
+  return true;
+}
+
+bool Sudoku::singular()
+{
+  return (this->count_solutions(2) == 1);
+}
+
+bool Sudoku::singular_parallel(std::size_t threads)
+{
+  return this->singular_parallel(threads, SolveLimits()).unique();
+}
+
+SolutionCount Sudoku::singular_parallel(std::size_t threads, SolveLimits const& limits)
+{
+  Watchdog watchdog(limits);
+  SolveStats* stats = this->begin_solve();
+  SolveScope scope(*this->kernel, stats, guard_for(watchdog));
+  SolutionCount count;
+
+  if (this->validate())
   {
-    return false;
+    ThreadPool pool(threads);
+    count.solutions = this->kernel->count_parallel(this->grid, 2, pool);
+    count.aborted = watchdog.tripped() && count.solutions < 2;
   }
+
+  return count;
 }
 
 bool Sudoku::good() const
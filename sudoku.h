@@ -20,30 +20,41 @@
 #define SUDOKU_H
 
 #include <cstddef>
+#include <memory>
 #include <streambuf>
 #include <string>
 #include <vector>
 
+#include "cache.h"
 #include "grid.h"
+#include "kernel.h"
+#include "reader.h"
+#include "serializer.h"
+#include "stats.h"
+#include "watchdog.h"
 
 /**
  * @brief This is a class designed to quickly and easily solve puzzles for the popular game Sudoku.
  * 
  * If you want to solve a puzzle, first create a Sudoku object. Next, you have to tell the class
  * what it is working with: you have to provide a puzzle to the object. You can do this by calling
- * either read_puzzle_from_file() or read_puzzle_from_string(). Once you do that, you should check
- * to make sure the puzzle was read in correctly by calling good(). Now that the class knows what it
- * is dealing with, it can start solving the puzzle: just call one of the solver methods. These
- * methods include: solve_colorability_style() and solve_bruteforce_style(). Once you call one of
- * those methods, the solution to the puzzle will be saved in the object.
+ * read_puzzle_from_file(), read_puzzle_from_string(), read_puzzle_from_line() or
+ * read_puzzle_from_reader(). Once you do that, you should check to make sure the puzzle was read in
+ * correctly by calling good(). Now that the class knows what it is dealing with, it can start
+ * solving the puzzle: just call one of the solver methods. These methods include:
+ * solve_colorability_style(), solve_dsatur_style(), solve_bruteforce_style(), solve_dlx(),
+ * solve_bitboard_style() and solve_parallel_style(). Once you call one of those methods, the
+ * solution to the puzzle will be saved in the object. Every solver method also takes optional
+ * SolveLimits (a deadline, a node budget and a cancellation flag), and tells you whether the
+ * puzzle was solved, has no solution, or whether the search was aborted by one of those limits.
  * 
- * Please note that due to memory constraints, this class can only ever hope to solve puzzles up to
- * size 64*64. The actual Sudoku grid validations are performed by using bit hacks on 64-bit
- * unsigned integers, so anything over 64 would cause an overflow. However, it is certainly not
- * realistic to expect a solution for such a large board: if even a quarter of the cells in a 64*64
- * board were unknown, there would be over 1000 unknowns, which means there would be over 1000
- * recursive function calls, each one taking up a portion of the stack and each one attempting to
- * allocate memory on the heap. This could lead to a stack or heap overflow (memory exhaustion).
+ * Please note that this class can only ever hope to solve puzzles up to size 144*144 (see
+ * Grid::MAX_N). The Sudoku grid validations are performed by using bit hacks on color masks, which
+ * are 64-bit unsigned integers up to 64*64 and multi-word Bitsets above that. The solvers do not
+ * recurse: they keep an explicit stack with room for one decision per cell, which is allocated
+ * before the search starts (see Solver). So even on a 144*144 board, where there could be tens of
+ * thousands of unknowns, the memory used by a search is bounded and known up front, but the time
+ * it takes may not be.
  **/
 class Sudoku
 {
@@ -52,8 +63,22 @@ public:
    * @brief Constructor for a Sudoku instance.
    **/
   Sudoku();
+  /**
+   * @brief Copy-construct a Sudoku instance from another one
+   *
+   * @param sudoku The other instance.
+   **/
+  Sudoku(Sudoku const& sudoku);
   virtual ~Sudoku();
 
+  /**
+   * @brief Copy another Sudoku instance
+   *
+   * @param sudoku The other instance.
+   * @return Sudoku& The current instance.
+   **/
+  Sudoku& operator =(Sudoku const& sudoku);
+
   /**
    * @brief Read in the puzzle from a given FILE* (this defaults to standard input) and store it in
    *        memory.
@@ -74,6 +99,35 @@ public:
    * @return bool Whether the parsing succeeded.
    **/
   bool read_puzzle_from_string(std::string const& s);
+  /**
+   * @brief Read in the puzzle from a single line, the compact format used by most puzzle
+   *        collections, and then store it in memory.
+   *
+   * @param line A string of n*n characters for a n*n Sudoku board, listing the cells row by row,
+   *             with '1'-'9' and then 'A'-'P' (or 'a'-'p') as the known values, and '.' or '0' for
+   *             unknown values. This format works for boards up to 25*25; bigger boards go on
+   *             one line as n*n values separated by spaces, with '?' or '.' for unknown values.
+   * @return bool Whether the parsing succeeded.
+   **/
+  bool read_puzzle_from_line(std::string const& line);
+  /**
+   * @brief Read in the next puzzle of a reader, such as one over a memory-mapped file of puzzles
+   *        (see PuzzleReader), and then store it in memory. This neither allocates nor throws, and
+   *        if the puzzle is malformed, the reader tells what was wrong and where.
+   *
+   * @param reader The reader, which must have a puzzle left (see PuzzleReader::done()).
+   * @return bool Whether the parsing succeeded, and the known values do not conflict.
+   **/
+  bool read_puzzle_from_reader(PuzzleReader& reader);
+  /**
+   * @brief Take a board that is already in memory, such as a record of a packed file (see
+   *        PackedCorpus), as the puzzle.
+   *
+   * @param grid The board, whose side length has to be a perfect square of at most 144, with every
+   *        value between 0 (unknown) and n.
+   * @return bool Whether the known values do not conflict.
+   **/
+  bool read_puzzle_from_grid(Grid const& grid);
 
   /**
    * @brief Print the current state of the board to some output stream.
@@ -87,30 +141,199 @@ public:
    * @return std::string The human-readable representation of the board.
    **/
   std::string to_s() const;
+  /**
+   * @brief Print the current state of the board to some output stream on a single line, in the
+   *        format read by read_puzzle_from_line() (see Layout::COMPACT). The line ends with a
+   *        newline, but the stream is not flushed, so that many boards can be printed in a row
+   *        cheaply.
+   *
+   * @param out An output stream.
+   **/
+  void print_line(std::ostream& out) const;
+  /**
+   * @brief Write the current state of the board into a buffer, without allocating (see Serializer)
+   *
+   * @param buffer Where to write the board. Nothing is written if it is too small.
+   * @param capacity The size of the buffer, which should be at least size().
+   * @param layout The layout to write the board in.
+   * @return std::size_t The number of characters written, or 0 if the buffer is too small.
+   **/
+  std::size_t write(char* buffer, std::size_t capacity, Layout layout) const;
+  /**
+   * @brief The number of characters it takes to write the current state of the board
+   *
+   * @param layout The layout to write the board in.
+   * @return std::size_t The number of characters.
+   **/
+  std::size_t size(Layout layout) const;
+  /**
+   * @brief The side length of the board
+   *
+   * @return std::size_t The side length, or 0 if there is no puzzle.
+   **/
+  std::size_t n() const;
+
+  /**
+   * @brief Determine whether the board is completely filled in without any conflicts.
+   *
+   * @return bool Whether the board is solved.
+   **/
+  bool solved() const;
 
   /**
-   * @brief Determine whether the puzzle has only a single solution by using the graph 9-coloring
-   *        technique. If there are no solutions or multiple solutions, the method will return true.
+   * @brief Count the solutions of the puzzle, stopping early once a limit is reached. The search
+   *        uses the same constraint propagation as the solver (the bitboard solver for 9*9
+   *        boards), so checking that a puzzle has a unique solution takes about as long as
+   *        solving it twice. The board itself is left unchanged.
+   *
+   * @param limit The number of solutions after which the search gives up.
+   * @param witnesses If given, it is overwritten with the first two solutions found (or fewer, if
+   *                  there are fewer), so an ambiguous puzzle comes with two distinct solutions
+   *                  that show it.
+   * @return std::size_t The number of solutions found, which is at most the limit. A board that
+   *                     breaks the rules has no solutions.
+   **/
+  std::size_t count_solutions(std::size_t limit, std::vector<Grid>* witnesses = nullptr);
+  /**
+   * @brief Count the solutions of the puzzle like count_solutions(), but give up once some limits
+   *        run out, so that a uniqueness check can be bounded too.
+   *
+   * @param limit The number of solutions after which the search gives up.
+   * @param limits When to give up on the search.
+   * @param witnesses If given, it is overwritten with the first two solutions found.
+   * @return SolutionCount The number of solutions found, and whether the limits ran out first.
+   **/
+  SolutionCount count_solutions(std::size_t limit, SolveLimits const& limits,
+                                std::vector<Grid>* witnesses = nullptr);
+  /**
+   * @brief Determine whether the puzzle has exactly one solution (see count_solutions()). If
+   *        there are no solutions or multiple solutions, the method will return false.
    *
    * @return bool Whether the Sudoku board has only 1 solution.
    **/
   bool singular();
+  /**
+   * @brief Determine whether the puzzle has only a single solution, like singular(), but search for
+   *        the solutions on several threads at once. The threads stop as soon as two solutions
+   *        have been found between them.
+   *
+   * @param threads The number of threads, or 0 for one per hardware thread.
+   * @return bool Whether the Sudoku board has only 1 solution.
+   **/
+  bool singular_parallel(std::size_t threads = 0);
+  /**
+   * @brief Count the solutions of the puzzle up to two on several threads at once, like
+   *        singular_parallel(), but give up once some limits run out.
+   *
+   * @param threads The number of threads, or 0 for one per hardware thread.
+   * @param limits When to give up on the search. The node budget is shared between the threads.
+   * @return SolutionCount The number of solutions found (see SolutionCount::unique()), and whether
+   *         the limits ran out first.
+   **/
+  SolutionCount singular_parallel(std::size_t threads, SolveLimits const& limits);
+
+  /**
+   * @brief Fill in the pencil marks of the puzzle: color the cells that are forced (naked and
+   *        hidden singles), and list the values every other cell may still take. The board itself
+   *        is left unchanged.
+   *
+   * @param marks Overwritten with the board, the forced cells filled in, and a candidate plane
+   *              (see Grid::candidates()). Left as it was if the puzzle breaks the rules.
+   * @return bool Whether the puzzle is still consistent.
+   **/
+  bool pencil_marks(Grid& marks);
 
   /**
    * @brief Attempt to solve the puzzle using the graph 9-coloring technique. If the puzzle was
    *        successfully solved, then the solution will be saved to memory (overwriting the existing
-   *        grid) and the method will return true. If the puzzle could not be solved for whatever
-   *        reason, then this method will return false.
+   *        grid). Otherwise the grid is left as it was.
+   *
+   * @param limits When to give up on the search (by default, never).
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
+   **/
+  SolveResult solve_colorability_style(SolveLimits const& limits = SolveLimits());
+  /**
+   * @brief Attempt to solve the puzzle using the graph 9-coloring technique, coloring the most
+   *        constrained node first (DSATUR): the node with the fewest colors left, with ties broken
+   *        by the number of uncolored nodes it is connected to. This finds the same kind of
+   *        solutions as solve_colorability_style(), but it usually explores far fewer nodes on
+   *        hard puzzles. If the puzzle was successfully solved, then the solution will be saved to
+   *        memory (overwriting the existing grid).
+   *
+   * @param limits When to give up on the search (by default, never).
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
    **/
-  void solve_colorability_style();
+  SolveResult solve_dsatur_style(SolveLimits const& limits = SolveLimits());
   /**
    * @brief Attempt to solve the puzzle by brute force. If the puzzle was successfully solved, then
-   *        the solution will be saved to memory (overwriting the existing grid) and the method will
-   *        return true. If the puzzle could not be solved for whatever reason, then this method
-   *        will return false. Note that this approach will take a very, very long time. However, it
-   *        will EVENTUALLY find a solution.
+   *        the solution will be saved to memory (overwriting the existing grid). Note that this
+   *        approach will take a very, very long time. However, it will EVENTUALLY find a solution,
+   *        unless the limits run out first.
+   *
+   * @param limits When to give up on the search (by default, never).
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
    **/
-  void solve_bruteforce_style();
+  SolveResult solve_bruteforce_style(SolveLimits const& limits = SolveLimits());
+  /**
+   * @brief Attempt to solve the puzzle by turning it into an exact cover problem and running
+   *        Knuth's Algorithm X on it, using dancing links (see DancingLinks). If the puzzle was
+   *        successfully solved, then the solution will be saved to memory (overwriting the
+   *        existing grid).
+   *
+   * @param limits When to give up on the search (by default, never).
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
+   **/
+  SolveResult solve_dlx(SolveLimits const& limits = SolveLimits());
+  /**
+   * @brief Attempt to solve a 9*9 puzzle with the bitboard solver (see BitboardSolver), which keeps
+   *        one 81-bit bitboard of candidate cells per digit in a SIMD register and propagates
+   *        singles and locked candidates with vector operations. This is the fastest strategy for
+   *        9*9 puzzles. Other board sizes fall back to solve_dsatur_style(). If the puzzle was
+   *        successfully solved, then the solution will be saved to memory (overwriting the
+   *        existing grid).
+   *
+   * @param limits When to give up on the search (by default, never).
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
+   **/
+  SolveResult solve_bitboard_style(SolveLimits const& limits = SolveLimits());
+  /**
+   * @brief Attempt to solve a puzzle on several threads at once, with the same search as
+   *        solve_dsatur_style(). The search tree is split into subtrees that idle threads pick up,
+   *        and all the threads stop as soon as one of them finds a solution, so this is meant for
+   *        a single large puzzle that would keep one core busy for a long time. If the puzzle was
+   *        successfully solved, then the solution will be saved to memory (overwriting the
+   *        existing grid).
+   *
+   * @param threads The number of threads, or 0 for one per hardware thread.
+   * @param limits When to give up on the search (by default, never). The node budget is shared
+   *        between the threads.
+   * @return SolveResult Whether the puzzle was solved, has no solution, or the search was aborted.
+   **/
+  SolveResult solve_parallel_style(std::size_t threads = 0,
+                                   SolveLimits const& limits = SolveLimits());
+
+  /**
+   * @brief Start or stop collecting statistics about every solve and count (see SolveStats). They
+   *        are off by default, and cost nothing when they are off.
+   *
+   * @param enabled Whether to collect them.
+   **/
+  void collect_stats(bool enabled);
+  /**
+   * @brief The statistics of the last solve (or count_solutions(), or singular_parallel())
+   *
+   * @return const SolveStats& The statistics, which are all zero if they were not being collected.
+   **/
+  SolveStats const& stats() const;
+
+  /**
+   * @brief Put a cache of solutions in front of every solver method (see SolutionCache), or take
+   *        it away with nullptr. The cache can be shared with other instances and threads. A
+   *        puzzle that is found in the cache is not solved again, so its statistics are all zero.
+   *
+   * @param cache The cache, which has to outlive its use.
+   **/
+  void use_cache(SolutionCache* cache);
 
   /**
    * @brief Accessor for Sudoku::status_ok
@@ -133,74 +356,72 @@ public:
 
 private:
   /**
-   * @brief Helper method for parsing a puzzle from a file
+   * @brief Helper method for parsing the next puzzle of a reader, which also picks the solver core
+   *        for the size of the puzzle
    *
-   * @param f The file from which we are reading.
+   * @param reader The reader.
    * @return bool Whether the parsing succeeded.
    **/
-  bool parse_puzzle(std::istream& f);
+  bool parse_puzzle(PuzzleReader& reader);
   /**
-   * @brief Helper method for parsing a single, tokenized row of a Sudoku grid
-   *
-   * @param tokens The row elements.
-   * @param y The index of the row.
-   * @return bool Whether the parsing succeeded.
+   * @brief Helper method for picking the solver core for the size of the board
    **/
-  bool insert_row(std::vector<std::string>& tokens, std::size_t y);
+  void fit_kernel();
   /**
    * @brief Helper method for checking whether the given puzzle is solvable
    * @return bool Whether the validation succeeded
    **/
-  bool validate() const;
-
+  bool validate();
   /**
-   * @brief Helper method for finding the next unknown (i.e., undetermined) Sudoku cell.
+   * @brief Helper method for the start of every solve: make sure there is a puzzle and clear the
+   *        statistics
    *
-   * @param cur_board The Sudoku game board.
-   * @param cur_x The last x position considered on the game board.
-   * @param cur_y The last y position considered on the game board.
-   * @param x_out The x position of the next unknown cell.
-   * @param y_out The y position of the next unknown cell.
-   * @return bool Whether we were able to find an unknown cell.
+   * @return SolveStats* The statistics to fill in, or nullptr.
    **/
-  static bool find_unknown(Grid& cur_grid, std::size_t cur_x, std::size_t cur_y,
-    std::size_t& x_out, std::size_t& y_out);
-
+  SolveStats* begin_solve();
   /**
-   * @brief Helper method for solving an instance of a Sudoku puzzle using the graph 9-colorability
-   *        solution method. If a 9-coloring is found, the method will return true and overwrite
-   *        cur_board with the solution (which corresponds with the graph coloring).
+   * @brief Helper method for the solver methods: look the puzzle up in the cache, if there is one
    *
-   * @param cur_board The Sudoku game board.
-   * @param cur_x The last x position considered on the game board. Defaults to 0.
-   * @param cur_y The last y position considered on the game board. Defaults to 0.
-   * @return bool Whether we were able to find a 9-coloring for the Sudoku board.
+   * @param result Set to how the puzzle turned out, if it was found.
+   * @return bool Whether it was found, in which case the board holds its solution.
    **/
-  static bool color_node(Grid& cur_grid, std::size_t cur_x = 0, std::size_t cur_y = 0);
+  bool recall(SolveResult& result);
   /**
-   * @brief Helper method for solving an instance of a Sudoku puzzle using the bruteforce solution
-   *        method. If a solution is found, the method will return true and overwrite cur_board with
-   *        the solution.
+   * @brief Helper method for the solver methods: put the outcome of a solve in the cache, if there
+   *        is one
    *
-   * @param cur_grid ...
-   * @param cur_x ... Defaults to 0.
-   * @param cur_y ... Defaults to 0.
-   * @return bool
+   * @param result How the solve turned out.
+   * @return SolveResult The same outcome.
    **/
-  static bool bruteforce_node(Grid& cur_grid, std::size_t cur_x = 0, std::size_t cur_y = 0);
-
-  static int singular_decider(Grid& cur_grid, bool found_one = false, std::size_t cur_x = 0,
-                               std::size_t cur_y = 0);
+  SolveResult remember(SolveResult result);
 
   /**
    * @brief The Sudoku board, which we are saving in memory.
    **/
   Grid grid;
 
+  /**
+   * @brief The solver core for the size of the board, which is picked as soon as the size is known.
+   **/
+  std::unique_ptr<Kernel> kernel;
+
   /**
    * @brief Whether the board is initialized (i.e., can we operate on this object?)
    **/
   bool status_ok;
+
+  /**
+   * @brief The statistics of the last solve, and whether they are being collected.
+   **/
+  SolveStats statistics;
+  bool collecting;
+
+  /**
+   * @brief The cache in front of the solvers, if any, and the canonical form of the puzzle being
+   *        solved.
+   **/
+  SolutionCache* solutions;
+  CanonicalForm form;
 };
 
 #endif // SUDOKU_H
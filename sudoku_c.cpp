@@ -0,0 +1,273 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sudoku_c.h"
+#include "sudoku.h"
+
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <new>
+
+/**
+ * @brief A handle of the C interface: one Sudoku instance, and the description of its last failure
+ **/
+struct sudoku_solver
+{
+  sudoku_solver()
+  {
+    this->message[0] = '\0';
+  }
+
+  Sudoku sudoku;
+  /**
+   * @brief A fixed buffer, so that reporting a failure never allocates (or throws).
+   **/
+  mutable char message[256];
+};
+
+namespace
+{
+  unsigned const ABI_VERSION = 1;
+
+  int fail(sudoku_solver const* solver, int status, char const* message)
+  {
+    std::strncpy(solver->message, message, sizeof(solver->message) - 1);
+    solver->message[sizeof(solver->message) - 1] = '\0';
+    return status;
+  }
+
+  /**
+   * @brief Run the body of a function of the C interface, and turn any exception it throws into a
+   *        status
+   **/
+  template <class Body>
+  int guarded(sudoku_solver const* solver, Body body)
+  {
+    if (solver == nullptr)
+    {
+      return SUDOKU_BAD_ARGUMENT;
+    }
+
+    solver->message[0] = '\0';
+
+    try
+    {
+      return body();
+    }
+    catch (std::bad_alloc const&)
+    {
+      return fail(solver, SUDOKU_ERROR, "out of memory");
+    }
+    catch (std::exception const& e)
+    {
+      return fail(solver, SUDOKU_ERROR, e.what());
+    }
+    catch (...)
+    {
+      return fail(solver, SUDOKU_ERROR, "unknown error");
+    }
+  }
+
+  bool layout_of(int layout, Layout& out)
+  {
+    if (layout != SUDOKU_SPACED && layout != SUDOKU_COMPACT)
+    {
+      return false;
+    }
+
+    out = (layout == SUDOKU_SPACED) ? Layout::SPACED : Layout::COMPACT;
+    return true;
+  }
+}
+
+unsigned sudoku_abi_version(void)
+{
+  return ABI_VERSION;
+}
+
+sudoku_solver* sudoku_create(void)
+{
+  try
+  {
+    return new sudoku_solver();
+  }
+  catch (...)
+  {
+    return nullptr;
+  }
+}
+
+void sudoku_destroy(sudoku_solver* solver)
+{
+  delete solver;
+}
+
+int sudoku_load(sudoku_solver* solver, char const* data, size_t size)
+{
+  return guarded(solver, [=]() -> int
+  {
+    if (data == nullptr && size > 0)
+    {
+      return fail(solver, SUDOKU_BAD_ARGUMENT, "the puzzle is null");
+    }
+
+    PuzzleReader reader(data, size);
+
+    if (!solver->sudoku.read_puzzle_from_reader(reader))
+    {
+      //either the reader found a problem, or the puzzle is well-formed but contradicts itself
+      return fail(solver, SUDOKU_INVALID,
+                  reader.failed() ? reader.error_message() : "the known values conflict");
+    }
+
+    return SUDOKU_OK;
+  });
+}
+
+int sudoku_solve(sudoku_solver* solver, int strategy, unsigned timeout_ms)
+{
+  return guarded(solver, [=]() -> int
+  {
+    Sudoku& sudoku = solver->sudoku;
+
+    if (!sudoku.good())
+    {
+      return fail(solver, SUDOKU_NOT_LOADED, "no puzzle has been loaded");
+    }
+
+    SolveLimits limits;
+
+    if (timeout_ms > 0)
+    {
+      limits = SolveLimits::within(std::chrono::milliseconds(timeout_ms));
+    }
+
+    SolveResult result;
+
+    switch (strategy)
+    {
+      case SUDOKU_COLORABILITY:
+        result = sudoku.solve_colorability_style(limits);
+        break;
+      case SUDOKU_DSATUR:
+        result = sudoku.solve_dsatur_style(limits);
+        break;
+      case SUDOKU_BRUTEFORCE:
+        result = sudoku.solve_bruteforce_style(limits);
+        break;
+      case SUDOKU_DLX:
+        result = sudoku.solve_dlx(limits);
+        break;
+      case SUDOKU_BITBOARD:
+        result = sudoku.solve_bitboard_style(limits);
+        break;
+      default:
+        return fail(solver, SUDOKU_BAD_ARGUMENT, "unknown strategy");
+    }
+
+    switch (result)
+    {
+      case SolveResult::SOLVED:
+        return SUDOKU_OK;
+      case SolveResult::UNSOLVABLE:
+        return fail(solver, SUDOKU_UNSOLVABLE, "the puzzle has no solution");
+      default:
+        return fail(solver, SUDOKU_ABORTED, "the solve ran out of time");
+    }
+  });
+}
+
+int sudoku_count(sudoku_solver* solver, size_t limit, size_t* count)
+{
+  return guarded(solver, [=]() -> int
+  {
+    if (count == nullptr)
+    {
+      return fail(solver, SUDOKU_BAD_ARGUMENT, "the count is null");
+    }
+
+    if (!solver->sudoku.good())
+    {
+      return fail(solver, SUDOKU_NOT_LOADED, "no puzzle has been loaded");
+    }
+
+    *count = solver->sudoku.count_solutions(limit);
+    return SUDOKU_OK;
+  });
+}
+
+size_t sudoku_n(sudoku_solver const* solver)
+{
+  return (solver != nullptr) ? solver->sudoku.n() : 0;
+}
+
+size_t sudoku_size(sudoku_solver const* solver, int layout)
+{
+  Layout chosen;
+
+  if (solver == nullptr || !solver->sudoku.good() || !layout_of(layout, chosen))
+  {
+    return 0;
+  }
+
+  return solver->sudoku.size(chosen);
+}
+
+int sudoku_write(sudoku_solver const* solver, int layout, char* buffer, size_t capacity,
+                 size_t* written)
+{
+  return guarded(solver, [=]() -> int
+  {
+    Layout chosen;
+
+    if (written != nullptr)
+    {
+      *written = 0;
+    }
+
+    if (!layout_of(layout, chosen))
+    {
+      return fail(solver, SUDOKU_BAD_ARGUMENT, "unknown layout");
+    }
+
+    if (!solver->sudoku.good())
+    {
+      return fail(solver, SUDOKU_NOT_LOADED, "no puzzle has been loaded");
+    }
+
+    if (buffer == nullptr || capacity < solver->sudoku.size(chosen))
+    {
+      return fail(solver, SUDOKU_TOO_SMALL, "the buffer is too small");
+    }
+
+    std::size_t length = solver->sudoku.write(buffer, capacity, chosen);
+
+    if (written != nullptr)
+    {
+      *written = length;
+    }
+
+    return SUDOKU_OK;
+  });
+}
+
+char const* sudoku_error(sudoku_solver const* solver)
+{
+  return (solver != nullptr) ? solver->message : "the handle is null";
+}
@@ -0,0 +1,166 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUDOKU_C_H
+#define SUDOKU_C_H
+
+#include <stddef.h>
+
+#if defined(__GNUC__)
+#define SUDOKU_API __attribute__((visibility("default")))
+#else
+#define SUDOKU_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief The C interface of libsudoku, for programs and bindings that cannot use the C++ classes
+ *
+ * A handle holds one puzzle, and the solver state for its board size, which stays warm from one
+ * puzzle to the next: create a handle once, and then load, solve and write out as many puzzles as
+ * you like, from and to flat buffers. Every function reports failures through its return value;
+ * no C++ exception ever crosses this interface. A handle must only be used by one thread at a
+ * time, but different handles can be used by different threads at once.
+ *
+ * The functions that can fail return one of the statuses below, and sudoku_error() describes the
+ * last failure of a handle.
+ **/
+typedef struct sudoku_solver sudoku_solver;
+
+enum sudoku_status
+{
+  /** @brief The call succeeded, or the puzzle was solved. **/
+  SUDOKU_OK = 0,
+  /** @brief The puzzle has no solution. **/
+  SUDOKU_UNSOLVABLE = 1,
+  /** @brief The solve ran out of time, and the puzzle is unchanged. **/
+  SUDOKU_ABORTED = 2,
+  /** @brief The puzzle cannot be read, or its known values conflict. **/
+  SUDOKU_INVALID = 3,
+  /** @brief No puzzle has been loaded. **/
+  SUDOKU_NOT_LOADED = 4,
+  /** @brief The output buffer is too small. **/
+  SUDOKU_TOO_SMALL = 5,
+  /** @brief A handle is null, or a strategy or layout is unknown. **/
+  SUDOKU_BAD_ARGUMENT = 6,
+  /** @brief Anything else, such as running out of memory. **/
+  SUDOKU_ERROR = 7
+};
+
+enum sudoku_strategy
+{
+  SUDOKU_COLORABILITY = 0,
+  SUDOKU_DSATUR = 1,
+  SUDOKU_BRUTEFORCE = 2,
+  SUDOKU_DLX = 3,
+  SUDOKU_BITBOARD = 4
+};
+
+enum sudoku_layout
+{
+  /** @brief One line per row, with the values separated by spaces. **/
+  SUDOKU_SPACED = 0,
+  /** @brief The whole board on one line. **/
+  SUDOKU_COMPACT = 1
+};
+
+/**
+ * @brief The version of this interface, which only changes when it does so incompatibly
+ **/
+SUDOKU_API unsigned sudoku_abi_version(void);
+
+/**
+ * @brief Create a handle
+ *
+ * @return sudoku_solver* The handle, or NULL if there is not enough memory.
+ **/
+SUDOKU_API sudoku_solver* sudoku_create(void);
+/**
+ * @brief Destroy a handle. Passing NULL does nothing.
+ **/
+SUDOKU_API void sudoku_destroy(sudoku_solver* solver);
+
+/**
+ * @brief Load a puzzle, in any of the formats read by the command-line tool: a grid of lines, or
+ *        a single line
+ *
+ * @param solver The handle.
+ * @param data The puzzle, which does not need to be null-terminated.
+ * @param size The length of the puzzle in bytes.
+ * @return int SUDOKU_OK, or SUDOKU_INVALID if the puzzle cannot be read or its known values
+ *         conflict, in which case no puzzle is loaded.
+ **/
+SUDOKU_API int sudoku_load(sudoku_solver* solver, char const* data, size_t size);
+/**
+ * @brief Solve the loaded puzzle, and replace it with the solution
+ *
+ * @param solver The handle.
+ * @param strategy One of the sudoku_strategy values.
+ * @param timeout_ms How long the solve may take in milliseconds, or 0 for as long as it takes.
+ * @return int SUDOKU_OK, SUDOKU_UNSOLVABLE or SUDOKU_ABORTED.
+ **/
+SUDOKU_API int sudoku_solve(sudoku_solver* solver, int strategy, unsigned timeout_ms);
+/**
+ * @brief Count the solutions of the loaded puzzle, up to a limit
+ *
+ * @param solver The handle.
+ * @param limit The most solutions to look for; 2 is enough to tell whether a puzzle is unique.
+ * @param count Set to the number of solutions found.
+ * @return int SUDOKU_OK.
+ **/
+SUDOKU_API int sudoku_count(sudoku_solver* solver, size_t limit, size_t* count);
+
+/**
+ * @brief The side length of the loaded puzzle, or 0 if none is loaded
+ **/
+SUDOKU_API size_t sudoku_n(sudoku_solver const* solver);
+/**
+ * @brief The number of bytes it takes to write the loaded puzzle, or 0 if none is loaded
+ *
+ * @param solver The handle.
+ * @param layout One of the sudoku_layout values.
+ **/
+SUDOKU_API size_t sudoku_size(sudoku_solver const* solver, int layout);
+/**
+ * @brief Write the loaded puzzle (or its solution, after sudoku_solve()) into a buffer. Nothing is
+ *        added after the last value, not even a null terminator.
+ *
+ * @param solver The handle.
+ * @param layout One of the sudoku_layout values.
+ * @param buffer The buffer.
+ * @param capacity The size of the buffer in bytes, which has to be at least sudoku_size().
+ * @param written Set to the number of bytes written, unless it is NULL.
+ * @return int SUDOKU_OK or SUDOKU_TOO_SMALL.
+ **/
+SUDOKU_API int sudoku_write(sudoku_solver const* solver, int layout, char* buffer,
+                            size_t capacity, size_t* written);
+
+/**
+ * @brief A description of the last failure of a handle, which stays valid until the next call
+ *        on it
+ **/
+SUDOKU_API char const* sudoku_error(sudoku_solver const* solver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SUDOKU_C_H
@@ -0,0 +1,185 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.h"
+
+namespace
+{
+  /**
+   * @brief The pool that the current thread works for, if any, and its index in that pool
+   **/
+  thread_local ThreadPool const* current_pool = nullptr;
+  thread_local std::size_t current_worker = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t threads)
+  : queued(0), pending(0), sleeping(0), stopping(false)
+{
+  if (threads == 0)
+  {
+    threads = default_threads();
+  }
+
+  for (std::size_t i = 0; i < threads; i++)
+  {
+    this->workers.emplace_back(new Worker());
+  }
+
+  for (std::size_t i = 0; i < threads; i++)
+  {
+    this->threads.emplace_back(&ThreadPool::run, this, i);
+  }
+}
+
+ThreadPool::~ThreadPool()
+{
+  this->wait();
+
+  {
+    std::lock_guard<std::mutex> guard(this->idle_lock);
+    this->stopping = true;
+  }
+
+  this->work_ready.notify_all();
+
+  for (std::thread& thread : this->threads)
+  {
+    thread.join();
+  }
+}
+
+std::size_t ThreadPool::size() const
+{
+  return this->workers.size();
+}
+
+std::size_t ThreadPool::default_threads()
+{
+  std::size_t threads = std::thread::hardware_concurrency();
+  return (threads == 0) ? 1 : threads;
+}
+
+void ThreadPool::submit(Task task)
+{
+  //a worker keeps its own tasks, which are likely to be related to the one it is running
+  Worker& worker = (current_pool == this) ? *this->workers[current_worker] : this->injected;
+
+  //count the task first, so that the counts never drop below the number of tasks in the deques
+  this->pending++;
+  this->queued++;
+
+  {
+    std::lock_guard<std::mutex> guard(worker.lock);
+    worker.tasks.push_back(std::move(task));
+  }
+
+  //take the lock so that a worker cannot miss the wakeup between checking for work and sleeping
+  {
+    std::lock_guard<std::mutex> guard(this->idle_lock);
+  }
+
+  this->work_ready.notify_one();
+}
+
+void ThreadPool::wait()
+{
+  std::unique_lock<std::mutex> guard(this->idle_lock);
+
+  while (this->pending != 0)
+  {
+    this->work_done.wait(guard);
+  }
+}
+
+bool ThreadPool::hungry() const
+{
+  return this->sleeping != 0 && this->queued == 0;
+}
+
+bool ThreadPool::take(std::size_t self, Task& task)
+{
+  std::size_t count = this->workers.size();
+
+  //our own deque, then the shared queue, then everyone else's deques
+  for (std::size_t i = 0; i <= count; i++)
+  {
+    Worker& worker = (i == 0) ? *this->workers[self]
+      : (i == 1) ? this->injected : *this->workers[(self + i - 1) % count];
+    std::lock_guard<std::mutex> guard(worker.lock);
+
+    if (!worker.tasks.empty())
+    {
+      //the newest task from our own deque, or the oldest one from any other queue
+      if (i == 0)
+      {
+        task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+      }
+      else
+      {
+        task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+      }
+
+      this->queued--;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+void ThreadPool::run(std::size_t self)
+{
+  current_pool = this;
+  current_worker = self;
+
+  while (true)
+  {
+    Task task;
+
+    if (this->take(self, task))
+    {
+      task(self);
+
+      if (--this->pending == 0)
+      {
+        std::lock_guard<std::mutex> guard(this->idle_lock);
+        this->work_done.notify_all();
+      }
+    }
+    else
+    {
+      std::unique_lock<std::mutex> guard(this->idle_lock);
+
+      this->sleeping++;
+
+      while (this->queued == 0 && !this->stopping)
+      {
+        this->work_ready.wait(guard);
+      }
+
+      this->sleeping--;
+
+      if (this->queued == 0 && this->stopping)
+      {
+        return;
+      }
+    }
+  }
+}
@@ -0,0 +1,140 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed set of worker threads that share tasks by work stealing
+ *
+ * Every worker has its own deque of the tasks it submitted itself, and takes its next task from the
+ * back of it, so related work runs together while it is still in the cache. Tasks submitted from
+ * outside the pool go to a shared queue instead, which the workers take from the front, so they
+ * start in the order they were submitted (a batch writes its results out in that order, and must
+ * not wait on its oldest task). Only when both are empty does a worker steal from the front of
+ * another worker's deque, so a worker stuck on a long task never holds up the tasks queued behind
+ * it.
+ *
+ * Each task is told the index of the worker running it, so that it can use state that belongs to
+ * that worker without locking. Tasks must not throw.
+ **/
+class ThreadPool
+{
+public:
+  /**
+   * @brief A unit of work, which is passed the index of the worker running it
+   **/
+  typedef std::function<void(std::size_t)> Task;
+
+  /**
+   * @brief Start the workers
+   *
+   * @param threads The number of workers, or 0 for one per hardware thread.
+   **/
+  explicit ThreadPool(std::size_t threads = 0);
+  /**
+   * @brief Run the tasks that are left, and then stop the workers
+   **/
+  ~ThreadPool();
+
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator =(ThreadPool const&) = delete;
+
+  /**
+   * @brief The number of workers
+   **/
+  std::size_t size() const;
+
+  /**
+   * @brief Queue a task
+   *
+   * @param task The task, which will run on one of the workers.
+   **/
+  void submit(Task task);
+  /**
+   * @brief Block until every task submitted so far (and every task those submitted) has run.
+   *        This must not be called by a task.
+   **/
+  void wait();
+  /**
+   * @brief Whether a worker is waiting for work while there is none queued, so that a long task
+   *        could hand some of its work over (as a parallel search does with its subtrees)
+   **/
+  bool hungry() const;
+
+  /**
+   * @brief The number of threads to use when the caller does not say
+   *
+   * @return std::size_t The number of hardware threads, or 1 if it is not known.
+   **/
+  static std::size_t default_threads();
+
+private:
+  /**
+   * @brief The tasks queued on one worker
+   **/
+  struct Worker
+  {
+    std::mutex lock;
+    std::deque<Task> tasks;
+  };
+
+  /**
+   * @brief The main loop of a worker
+   **/
+  void run(std::size_t self);
+  /**
+   * @brief Take a task from the worker's own deque, or else from the shared queue, or else steal
+   *        one from another worker
+   *
+   * @return bool Whether a task was found.
+   **/
+  bool take(std::size_t self, Task& task);
+
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::vector<std::thread> threads;
+  /**
+   * @brief The tasks submitted from outside the pool, oldest first.
+   **/
+  Worker injected;
+
+  /**
+   * @brief The tasks waiting in the deques, the tasks that have not finished yet, and the workers
+   *        that are asleep.
+   **/
+  std::atomic<std::size_t> queued, pending, sleeping;
+  bool stopping;
+
+  /**
+   * @brief Idle workers sleep on this lock until there is work, and wait() until there is none.
+   **/
+  std::mutex idle_lock;
+  std::condition_variable work_ready, work_done;
+};
+
+#endif // THREAD_POOL_H
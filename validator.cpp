@@ -18,56 +18,61 @@
 
 #include "validator.h"
 
+#include <cmath>
+
+template <class Mask>
 bool Validator::is_good_row(Grid const& cur_grid, std::size_t y)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0, valid_mask = (1 << n) - 1;
+  Mask mask = 0, valid_mask = Bits::all_colors<Mask>(n);
 
   for (std::size_t x = 0; x < n; x++)
   {
     int a = cur_grid.get(x, y);
 
     //reject rows that are incomplete or have duplicates
-    if ((a == -1) || ((mask & (1 << (a - 1))) != 0))
+    if ((a == -1) || ((mask & Bits::color_bit<Mask>(a)) != 0))
     {
       return false;
     }
     else
     {
-      mask |= (1 << (a - 1));
+      mask |= Bits::color_bit<Mask>(a);
     }
   }
 
   return (mask == valid_mask);
 }
 
+template <class Mask>
 bool Validator::is_good_column(Grid const& cur_grid, std::size_t x)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0, valid_mask = (1 << n) - 1;
+  Mask mask = 0, valid_mask = Bits::all_colors<Mask>(n);
 
   for (std::size_t y = 0; y < n; y++)
   {
     int a = cur_grid.get(x, y);
 
     //reject cols that are incomplete or have duplicates
-    if ((a == -1) || ((mask & (1 << (a - 1))) != 0))
+    if ((a == -1) || ((mask & Bits::color_bit<Mask>(a)) != 0))
     {
       return false;
     }
     else
     {
-      mask |= (1 << (a - 1));
+      mask |= Bits::color_bit<Mask>(a);
     }
   }
 
   return (mask == valid_mask);
 }
 
+template <class Mask>
 bool Validator::is_good_block(Grid const& cur_grid, std::size_t x, std::size_t y)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
-  std::uint_fast64_t mask = 0, valid_mask = (1 << n) - 1;
+  Mask mask = 0, valid_mask = Bits::all_colors<Mask>(n);
 
   for (std::size_t y_off = 0; y_off < n_root; y_off++)
   {
@@ -76,13 +81,13 @@ bool Validator::is_good_block(Grid const& cur_grid, std::size_t x, std::size_t y
       int a = cur_grid.get(x + x_off, y + y_off);
 
       //reject blocks that are incomplete or have duplicates
-      if ((a == -1) || ((mask & (1 << (a - 1))) != 0))
+      if ((a == -1) || ((mask & Bits::color_bit<Mask>(a)) != 0))
       {
         return false;
       }
       else
       {
-        mask |= (1 << (a - 1));
+        mask |= Bits::color_bit<Mask>(a);
       }
     }
   }
@@ -91,12 +96,29 @@ bool Validator::is_good_block(Grid const& cur_grid, std::size_t x, std::size_t y
 }
 
 bool Validator::is_good_board(Grid const& cur_grid)
+{
+  if (cur_grid.n() <= 64)
+  {
+    return good_board<std::uint_fast64_t>(cur_grid);
+  }
+  else if (cur_grid.n() <= 128)
+  {
+    return good_board<Mask128>(cur_grid);
+  }
+  else
+  {
+    return good_board<Mask192>(cur_grid);
+  }
+}
+
+template <class Mask>
+bool Validator::good_board(Grid const& cur_grid)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
 
   for (std::size_t y = 0; y < n; y++)
   {
-    if (!is_good_row(cur_grid, y))
+    if (!is_good_row<Mask>(cur_grid, y))
     {
       return false;
     }
@@ -104,7 +126,7 @@ bool Validator::is_good_board(Grid const& cur_grid)
 
   for (std::size_t x = 0; x < n; x++)
   {
-    if (!is_good_column(cur_grid, x))
+    if (!is_good_column<Mask>(cur_grid, x))
     {
       return false;
     }
@@ -114,7 +136,7 @@ bool Validator::is_good_board(Grid const& cur_grid)
   {
     for (std::size_t y = 0; y < n_root; y++)
     {
-      if (!is_good_block(cur_grid, x * n_root, y * n_root))
+      if (!is_good_block<Mask>(cur_grid, x * n_root, y * n_root))
       {
         return false;
       }
@@ -124,10 +146,11 @@ bool Validator::is_good_board(Grid const& cur_grid)
   return true;
 }
 
-std::uint_fast64_t Validator::row_colors(Grid const& cur_grid, std::size_t y)
+template <class Mask>
+Mask Validator::row_colors(Grid const& cur_grid, std::size_t y)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t x = 0; x < n; x++)
   {
@@ -136,17 +159,18 @@ std::uint_fast64_t Validator::row_colors(Grid const& cur_grid, std::size_t y)
     //ignore incomplete elements
     if (a != -1)
     {
-      mask |= (1 << (a - 1));
+      mask |= Bits::color_bit<Mask>(a);
     }
   }
 
   return mask;
 }
 
-std::uint_fast64_t Validator::column_colors(Grid const& cur_grid, std::size_t x)
+template <class Mask>
+Mask Validator::column_colors(Grid const& cur_grid, std::size_t x)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t y = 0; y < n; y++)
   {
@@ -155,17 +179,18 @@ std::uint_fast64_t Validator::column_colors(Grid const& cur_grid, std::size_t x)
     //ignore incomplete elements
     if (a != -1)
     {
-      mask |= (1 << (a - 1));
+      mask |= Bits::color_bit<Mask>(a);
     }
   }
 
   return mask;
 }
 
-std::uint_fast64_t Validator::block_colors(Grid const& cur_grid, std::size_t x, std::size_t y)
+template <class Mask>
+Mask Validator::block_colors(Grid const& cur_grid, std::size_t x, std::size_t y)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t y_off = 0; y_off < n_root; y_off++)
   {
@@ -176,7 +201,7 @@ std::uint_fast64_t Validator::block_colors(Grid const& cur_grid, std::size_t x,
       //ignore incomplete elements
       if (a != -1)
       {
-        mask |= (1 << (a - 1));
+        mask |= Bits::color_bit<Mask>(a);
       }
     }
   }
@@ -185,32 +210,55 @@ std::uint_fast64_t Validator::block_colors(Grid const& cur_grid, std::size_t x,
 }
 
 bool Validator::is_good_color(Grid const& cur_grid, std::size_t x, std::size_t y, int i)
+{
+  if (cur_grid.n() <= 64)
+  {
+    return good_color<std::uint_fast64_t>(cur_grid, x, y, i);
+  }
+  else if (cur_grid.n() <= 128)
+  {
+    return good_color<Mask128>(cur_grid, x, y, i);
+  }
+  else
+  {
+    return good_color<Mask192>(cur_grid, x, y, i);
+  }
+}
+
+template <class Mask>
+bool Validator::good_color(Grid const& cur_grid, std::size_t x, std::size_t y, int i)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
 
-  int bit = (1 << (i - 1));
-  std::uint_fast64_t row_mask = row_colors(cur_grid, y),
-    col_mask = column_colors(cur_grid, x),
-    block_mask = block_colors(cur_grid, (x / n_root) * n_root, (y / n_root) * n_root);
+  Mask bit = Bits::color_bit<Mask>(i);
+  Mask row_mask = row_colors<Mask>(cur_grid, y),
+    col_mask = column_colors<Mask>(cur_grid, x),
+    block_mask = block_colors<Mask>(cur_grid, (x / n_root) * n_root, (y / n_root) * n_root);
 
   return ((row_mask & bit) == 0 && (col_mask & bit) == 0 && (block_mask & bit) == 0);
 }
 
-std::uint_fast64_t Validator::good_colors(Grid const& cur_grid, std::size_t x, std::size_t y)
+template <class Mask>
+Mask Validator::good_colors(Grid const& cur_grid, std::size_t x, std::size_t y)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
 
-  std::uint_fast64_t row_mask = row_colors(cur_grid, y),
-    col_mask = column_colors(cur_grid, x),
-    block_mask = block_colors(cur_grid, (x / n_root) * n_root, (y / n_root) * n_root);
+  Mask row_mask = row_colors<Mask>(cur_grid, y),
+    col_mask = column_colors<Mask>(cur_grid, x),
+    block_mask = block_colors<Mask>(cur_grid, (x / n_root) * n_root, (y / n_root) * n_root);
 
-  return (~(row_mask | col_mask | block_mask)) & ((1 << n) - 1);
+  return (~(row_mask | col_mask | block_mask)) & Bits::all_colors<Mask>(n);
 }
 
+template std::uint_fast64_t Validator::good_colors(Grid const&, std::size_t, std::size_t);
+template Mask128 Validator::good_colors(Grid const&, std::size_t, std::size_t);
+template Mask192 Validator::good_colors(Grid const&, std::size_t, std::size_t);
+
+template <class Mask>
 bool Validator::is_good_partial_row(Grid const& cur_grid, std::size_t y)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t x = 0; x < n; x++)
   {
@@ -220,13 +268,13 @@ bool Validator::is_good_partial_row(Grid const& cur_grid, std::size_t y)
     if (a != -1)
     {
       //reject rows that have duplicates
-      if ((mask & (1 << (a - 1))) != 0)
+      if ((mask & Bits::color_bit<Mask>(a)) != 0)
       {
         return false;
       }
       else
       {
-        mask |= (1 << (a - 1));
+        mask |= Bits::color_bit<Mask>(a);
       }
     }
   }
@@ -234,10 +282,11 @@ bool Validator::is_good_partial_row(Grid const& cur_grid, std::size_t y)
   return true;
 }
 
+template <class Mask>
 bool Validator::is_good_partial_column(Grid const& cur_grid, std::size_t x)
 {
   const std::size_t n = cur_grid.n();
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t y = 0; y < n; y++)
   {
@@ -247,13 +296,13 @@ bool Validator::is_good_partial_column(Grid const& cur_grid, std::size_t x)
     if (a != -1)
     {
       //reject cols that have duplicates
-      if ((mask & (1 << (a - 1))) != 0)
+      if ((mask & Bits::color_bit<Mask>(a)) != 0)
       {
         return false;
       }
       else
       {
-        mask |= (1 << (a - 1));
+        mask |= Bits::color_bit<Mask>(a);
       }
     }
   }
@@ -261,10 +310,11 @@ bool Validator::is_good_partial_column(Grid const& cur_grid, std::size_t x)
   return true;
 }
 
+template <class Mask>
 bool Validator::is_good_partial_block(Grid const& cur_grid, std::size_t x, std::size_t y)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
-  std::uint_fast64_t mask = 0;
+  Mask mask = 0;
 
   for (std::size_t y_off = 0; y_off < n_root; y_off++)
   {
@@ -276,13 +326,13 @@ bool Validator::is_good_partial_block(Grid const& cur_grid, std::size_t x, std::
       if (a != -1)
       {
         //reject blocks that have duplicates
-        if ((mask & (1 << (a - 1))) != 0)
+        if ((mask & Bits::color_bit<Mask>(a)) != 0)
         {
           return false;
         }
         else
         {
-          mask |= (1 << (a - 1));
+          mask |= Bits::color_bit<Mask>(a);
         }
       }
     }
@@ -292,12 +342,29 @@ bool Validator::is_good_partial_block(Grid const& cur_grid, std::size_t x, std::
 }
 
 bool Validator::is_good_partial_board(Grid const& cur_grid)
+{
+  if (cur_grid.n() <= 64)
+  {
+    return good_partial_board<std::uint_fast64_t>(cur_grid);
+  }
+  else if (cur_grid.n() <= 128)
+  {
+    return good_partial_board<Mask128>(cur_grid);
+  }
+  else
+  {
+    return good_partial_board<Mask192>(cur_grid);
+  }
+}
+
+template <class Mask>
+bool Validator::good_partial_board(Grid const& cur_grid)
 {
   const std::size_t n = cur_grid.n(), n_root = std::size_t(sqrt(n) + 0.5);
 
   for (std::size_t y = 0; y < n; y++)
   {
-    if (!is_good_partial_row(cur_grid, y))
+    if (!is_good_partial_row<Mask>(cur_grid, y))
     {
       return false;
     }
@@ -305,7 +372,7 @@ bool Validator::is_good_partial_board(Grid const& cur_grid)
 
   for (std::size_t x = 0; x < n; x++)
   {
-    if (!is_good_partial_column(cur_grid, x))
+    if (!is_good_partial_column<Mask>(cur_grid, x))
     {
       return false;
     }
@@ -315,7 +382,7 @@ bool Validator::is_good_partial_board(Grid const& cur_grid)
   {
     for (std::size_t y = 0; y < n_root; y++)
     {
-      if (!is_good_partial_block(cur_grid, x * n_root, y * n_root))
+      if (!is_good_partial_block<Mask>(cur_grid, x * n_root, y * n_root))
       {
         return false;
       }
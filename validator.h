@@ -22,8 +22,16 @@
 #include <cstdint>
 #include <cstddef>
 
+#include "bits.h"
 #include "grid.h"
 
+/**
+ * @brief Checks boards against the rules, one unit at a time
+ *
+ * The units are checked with color masks, whose type is a template parameter of the helpers: a
+ * 64-bit integer for boards up to 64*64, and a Bitset as wide as the colors need above that. The
+ * public functions pick the narrowest mask for the board they are given.
+ **/
 class Validator
 {
 public:
@@ -40,6 +48,11 @@ public:
    **/
   static bool is_good_board(Grid const& cur_grid);
 private:
+  /**
+   * @brief Helper function for the above task, with the mask type picked.
+   **/
+  template <class Mask>
+  static bool good_board(Grid const& cur_grid);
   /**
    * @brief Helper function for the above task.
    *
@@ -47,6 +60,7 @@ private:
    * @param y The index for a particular row.
    * @return bool Whether the 1*n row contains no repeated or undetermined elements.
    **/
+  template <class Mask>
   static bool is_good_row(Grid const& cur_grid, std::size_t y);
   /**
    * @brief Helper function for the above task.
@@ -55,6 +69,7 @@ private:
    * @param x The index for a particular column.
    * @return bool Whether the n*1 column contains no repeated or undetermined elements.
    **/
+  template <class Mask>
   static bool is_good_column(Grid const& cur_grid, std::size_t x);
   /**
    * @brief Helper function for the above task.
@@ -64,6 +79,7 @@ private:
    * @param y The index for a particular starting column.  Must be a multiple of 3.
    * @return bool Whether the sqrt(n)*sqrt(n) block contains no repeated or undetermined elements.
    **/
+  template <class Mask>
   static bool is_good_block(Grid const& cur_grid, std::size_t x, std::size_t y);
 
 public:
@@ -88,41 +104,52 @@ public:
    * 
    * This validation will tell you whether you can use a specific color, provided that it does not
    * appear in the same row, in the same column, or the same 3x3 block. The result is encoded into a
-   * 64-bit unsigned integer, with the least significant bit corresponding to whether you can use
+   * color mask (see Bits), with the least significant bit corresponding to whether you can use
    * the color 1, the next bit corresponding to whether you can use the number 2, and so on.
    *
+   * @tparam Mask The type of the mask, which must have at least n bits: std::uint_fast64_t (the
+   *              default), Mask128 or Mask192.
    * @param cur_board A Sudoku puzzle board.
    * @param x The x position of the cell.
    * @param y The y position of the cell.
-   * @return uint_fast64_t The various colors (numbers) you may use, encoded using the above scheme.
+   * @return Mask The various colors (numbers) you may use, encoded using the above scheme.
    **/
-  static std::uint_fast64_t good_colors(Grid const& cur_grid, std::size_t x, std::size_t y);
+  template <class Mask = std::uint_fast64_t>
+  static Mask good_colors(Grid const& cur_grid, std::size_t x, std::size_t y);
 private:
+  /**
+   * @brief Helper function for is_good_color(), with the mask type picked.
+   **/
+  template <class Mask>
+  static bool good_color(Grid const& cur_grid, std::size_t x, std::size_t y, int i);
   /**
    * @brief Helper function for the above task. Tells you which colors have been used.
    *
    * @param cur_board A Sudoku puzzle board.
    * @param y The index for a particular row.
-   * @return int Which colors are used by that particular 1*n row.
+   * @return Mask Which colors are used by that particular 1*n row.
    **/
-  static std::uint_fast64_t row_colors(Grid const& cur_grid, std::size_t y);
+  template <class Mask>
+  static Mask row_colors(Grid const& cur_grid, std::size_t y);
   /**
    * @brief Helper function for the above task. Tells you which colors have been used.
    *
    * @param cur_board A Sudoku puzzle board.
    * @param x The index for a particular column.
-   * @return int Which colors are used by that particular n*1 column.
+   * @return Mask Which colors are used by that particular n*1 column.
    **/
-  static std::uint_fast64_t column_colors(Grid const& cur_grid, std::size_t x);
+  template <class Mask>
+  static Mask column_colors(Grid const& cur_grid, std::size_t x);
   /**
    * @brief Helper function for the above task. Tells you which colors have been used.
    *
    * @param cur_board A Sudoku puzzle board.
    * @param x The index for a particular starting row. Must be a multiple of 3.
    * @param y The index for a particular starting column.  Must be a multiple of 3.
-   * @return int Which colors are used by that particular sqrt(n)*sqrt(n) block.
+   * @return Mask Which colors are used by that particular sqrt(n)*sqrt(n) block.
    **/
-  static std::uint_fast64_t block_colors(Grid const& cur_grid, std::size_t x, std::size_t y);
+  template <class Mask>
+  static Mask block_colors(Grid const& cur_grid, std::size_t x, std::size_t y);
 
 public:
   /**
@@ -141,6 +168,11 @@ public:
    **/
   static bool is_good_partial_board(Grid const& cur_grid);
 private:
+  /**
+   * @brief Helper function for the above task, with the mask type picked.
+   **/
+  template <class Mask>
+  static bool good_partial_board(Grid const& cur_grid);
   /**
    * @brief Helper function for the above task.
    *
@@ -148,6 +180,7 @@ private:
    * @param y The index for a particular row.
    * @return bool Whether the given 1*n row has any repeated elements.
    **/
+  template <class Mask>
   static bool is_good_partial_row(Grid const& cur_grid, std::size_t y);
   /**
    * @brief Helper function for the above task.
@@ -156,6 +189,7 @@ private:
    * @param x The index for a particular column.
    * @return bool Whether the given n*1 column has any repeated elements.
    **/
+  template <class Mask>
   static bool is_good_partial_column(Grid const& cur_grid, std::size_t x);
   /**
    * @brief Helper function for the above task.
@@ -165,6 +199,7 @@ private:
    * @param y The index for a particular starting column.  Must be a multiple of 3.
    * @return bool Whether the given sqrt(n)*sqrt(n) block has any repeated elements.
    **/
+  template <class Mask>
   static bool is_good_partial_block(Grid const& cur_grid, std::size_t x, std::size_t y);
 };
 
@@ -0,0 +1,209 @@
+/*
+ *  Sudoku Base - a library for solving Sudoku puzzles
+ *  Copyright (C) 2013  Neal Patel <nealp9084@gmail.com>
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief How a solve turned out
+ **/
+enum class SolveResult
+{
+  /**
+   * @brief A solution was found, and it is on the board.
+   **/
+  SOLVED,
+  /**
+   * @brief The whole search tree was explored without finding a solution.
+   **/
+  UNSOLVABLE,
+  /**
+   * @brief The solve hit one of its limits (see SolveLimits) first, and the board is unchanged.
+   **/
+  ABORTED
+};
+
+/**
+ * @brief How a count of the solutions of a puzzle turned out
+ **/
+struct SolutionCount
+{
+  SolutionCount() : solutions(0), aborted(false)
+  {
+  }
+
+  /**
+   * @brief Whether the puzzle is known to have exactly one solution
+   **/
+  bool unique() const
+  {
+    return !this->aborted && this->solutions == 1;
+  }
+
+  /**
+   * @brief The number of solutions found, which is at most the limit of the count.
+   **/
+  std::size_t solutions;
+  /**
+   * @brief Whether the count hit one of its limits (see SolveLimits) first, in which case there
+   *        may be more solutions than were found.
+   **/
+  bool aborted;
+};
+
+/**
+ * @brief The bounds on how long a solve may run
+ *
+ * Any combination of a wall-clock deadline, a number of search nodes and a cancellation flag,
+ * which another thread can raise at any time. By default there are no limits at all.
+ **/
+struct SolveLimits
+{
+  typedef std::chrono::steady_clock clock;
+
+  SolveLimits() : deadline(clock::time_point::max()), max_nodes(UINT64_MAX), cancel(nullptr)
+  {
+  }
+
+  /**
+   * @brief Limits with a deadline some time from now
+   *
+   * @param timeout How long the solve may take.
+   * @return SolveLimits The limits.
+   **/
+  static SolveLimits within(clock::duration timeout)
+  {
+    SolveLimits limits;
+    limits.deadline = clock::now() + timeout;
+    return limits;
+  }
+
+  /**
+   * @brief Whether any limit is set
+   **/
+  bool bounded() const
+  {
+    return this->deadline != clock::time_point::max() || this->max_nodes != UINT64_MAX ||
+           this->cancel != nullptr;
+  }
+
+  /**
+   * @brief The time after which the solve gives up.
+   **/
+  clock::time_point deadline;
+  /**
+   * @brief The number of search nodes after which the solve gives up.
+   **/
+  std::uint64_t max_nodes;
+  /**
+   * @brief A flag that stops the solve as soon as it is set, or nullptr.
+   **/
+  std::atomic<bool> const* cancel;
+};
+
+/**
+ * @brief Keeps one solve within its limits
+ *
+ * A search calls expired() once per node. That counts the node and looks at the cancellation flag
+ * (a plain load on the common processors), and only every CLOCK_PERIOD nodes reads the clock, so
+ * a deadline is noticed within a few hundred nodes. Once a watchdog has expired, it stays expired.
+ * A watchdog belongs to a single thread, but the watchdogs of the threads of one search can share
+ * a node counter, so that the nodes of all of them are held to a single limit.
+ **/
+class Watchdog
+{
+public:
+  /**
+   * @brief The number of nodes between two looks at the clock
+   **/
+  static const std::uint64_t CLOCK_PERIOD = 256;
+
+  /**
+   * @brief Watch a solve
+   *
+   * @param limits The limits of the solve.
+   * @param tally If not null, the node counter shared with the other threads of the solve, which
+   *              is held to the limit in place of this watchdog's own count.
+   **/
+  explicit Watchdog(SolveLimits const& limits, std::atomic<std::uint64_t>* tally = nullptr)
+    : bounds(limits), tally(tally), nodes(0), fired(false)
+  {
+  }
+
+  /**
+   * @brief Count a node, and tell whether the search should give up
+   **/
+  bool expired()
+  {
+    if (!this->fired)
+    {
+      std::uint64_t counted = (this->tally != nullptr) ?
+                              this->tally->fetch_add(1, std::memory_order_relaxed) + 1 :
+                              this->nodes + 1;
+
+      this->nodes++;
+      this->fired = (counted > this->bounds.max_nodes) ||
+                    (this->bounds.cancel != nullptr &&
+                     this->bounds.cancel->load(std::memory_order_relaxed)) ||
+                    (this->nodes % CLOCK_PERIOD == 0 &&
+                     SolveLimits::clock::now() >= this->bounds.deadline);
+    }
+
+    return this->fired;
+  }
+
+  /**
+   * @brief Whether the search was told to give up
+   **/
+  bool tripped() const
+  {
+    return this->fired;
+  }
+  /**
+   * @brief Make the search (or what is left of it) give up
+   **/
+  void trip()
+  {
+    this->fired = true;
+  }
+
+  SolveLimits const& limits() const
+  {
+    return this->bounds;
+  }
+  /**
+   * @brief The number of nodes counted by this watchdog
+   **/
+  std::uint64_t visited() const
+  {
+    return this->nodes;
+  }
+
+private:
+  SolveLimits bounds;
+  std::atomic<std::uint64_t>* tally;
+  std::uint64_t nodes;
+  bool fired;
+};
+
+#endif // WATCHDOG_H